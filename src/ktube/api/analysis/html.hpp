@@ -3,6 +3,7 @@
 #include <HTML/HTML.h>
 #include "ktube/common/types.hpp"
 #include "ktube/common/util.hpp"
+#include "ktube/common/youtube_util.hpp"
 
 namespace ktube {
 /**
@@ -57,18 +58,6 @@ inline std::vector<std::string> keywords_from_string(std::string s)
   return keywords;
 }
 
-/**
- * youtube_id_to_url
- *
- * @param
- * @returns
- */
-inline std::string youtube_id_to_url(std::string id)
-{
-  return std::string{
-      "https://youtube.com/watch?v=" + id};
-}
-
 /**
  * youtube_title_link
  *
@@ -170,14 +159,14 @@ inline std::string channel_videos_to_html(const std::vector<ChannelInfo> &channe
     for (const auto& video : channel.videos)
     {
       table << (HTML::Row()
-                << HTML::Col(channel.name)             .style(constants::HTML_COL_VALUE_STYLE)
-                << HTML::Col(channel.stats.subscribers).style(constants::HTML_COL_VALUE_STYLE)
+                << HTML::Col(channel.name)                             .style(constants::HTML_COL_VALUE_STYLE)
+                << HTML::Col(std::to_string(channel.stats.subscribers)).style(constants::HTML_COL_VALUE_STYLE)
                 << HTML::Col(youtube_title_link(video.title, video.id)).style(constants::HTML_COL_VALUE_STYLE)
-                << HTML::Col(video.time)               .style(constants::HTML_COL_VALUE_STYLE)
-                << HTML::Col(video.stats.views)        .style(constants::HTML_COL_VALUE_STYLE)
-                << HTML::Col(video.stats.likes)        .style(constants::HTML_COL_VALUE_STYLE)
-                << HTML::Col(video.stats.dislikes)     .style(constants::HTML_COL_VALUE_STYLE)
-                << HTML::Col(video.stats.comments)     .style(constants::HTML_COL_VALUE_STYLE)
+                << HTML::Col(video.time)                               .style(constants::HTML_COL_VALUE_STYLE)
+                << HTML::Col(std::to_string(video.stats.views))        .style(constants::HTML_COL_VALUE_STYLE)
+                << HTML::Col(std::to_string(video.stats.likes))        .style(constants::HTML_COL_VALUE_STYLE)
+                << HTML::Col(std::to_string(video.stats.dislikes))     .style(constants::HTML_COL_VALUE_STYLE)
+                << HTML::Col(std::to_string(video.stats.comments))     .style(constants::HTML_COL_VALUE_STYLE)
       );
       table << (HTML::Row()
                 << HTML::Col(tags_to_string(video.stats.keywords))
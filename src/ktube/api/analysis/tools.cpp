@@ -9,7 +9,7 @@ kiq::ProcessResult execute(std::string program, std::vector<std::string> argv) {
   return kiq::qx(runtime_arguments, get_executable_cwd());
 }
 //-----------------------------------------------------------------------
-std::vector<GoogleTrend> query_google_trends(std::vector<std::string> terms) {
+std::vector<GoogleTrend> query_google_trends(const std::vector<std::string>& terms) {
   std::vector<std::string> argv;
   for (const auto& term : terms) argv.emplace_back(std::string{"-t=" + term});
 
@@ -22,35 +22,30 @@ std::vector<GoogleTrend> query_google_trends(std::vector<std::string> terms) {
 
 //-----------------------------------------------------------------------
 VideoStudy::VideoStudy(Videos videos)
-: m_videos(videos) {}
+: m_table(std::move(videos)) {}
 
 //-----------------------------------------------------------------------
 const VideoStudy::VideoStudyResult VideoStudy::analyze()
 {
   VideoStudyResult result{};
 
-  for (auto& video : m_videos)
+  for (Row row = 0; row < m_table.size(); row++)
   {
-    std::vector<std::string> keywords;
-    if (video.stats.keywords.size() > 3)
-      keywords.insert(keywords.end(), video.stats.keywords.begin(), video.stats.keywords.begin() + 3);
-    else
-      keywords = video.stats.keywords;
-
-    video.stats.view_score    = compute_view_score   (video);
-    video.stats.like_score    = compute_like_score   (video);
-    video.stats.dislike_score = compute_dislike_score(video);
-    video.stats.comment_score = compute_comment_score(video);
-    video.stats.trends        = query_google_trends  (keywords);
+    const std::vector<std::string>& all_keywords = m_table.keywords(row);
+    const std::vector<std::string>  keywords{all_keywords.begin(),
+                                             all_keywords.begin() + std::min<std::size_t>(3, all_keywords.size())};
+
+    m_table.set_trends(row, query_google_trends(keywords));
   }
 
+  m_table.score(std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count());
 
-  if (!m_videos.empty())
+  if (!m_table.empty())
   {
-    std::cout << __PRETTY_FUNCTION__ << ": Implement most comments max counter" << std::endl;
     result.most_likes        = most_liked();
     result.most_dislikes     = most_controversial();
-    result.most_comments     = m_videos.end();
+    result.most_comments     = most_commented();
     result.top_view_score    = top_view_score();
     result.top_like_score    = top_like_score();
     result.top_dislike_score = top_dislike_score();
@@ -60,171 +55,124 @@ const VideoStudy::VideoStudyResult VideoStudy::analyze()
   return result;
 }
 //-----------------------------------------------------------------------
-const VideoStudy::Videos::const_iterator VideoStudy::most_liked() const
-{
-  return std::max_element(m_videos.begin(), m_videos.end(),
-    [](const Video& a, const Video& b)
-    {
-      return std::stoi(a.stats.likes) < std::stoi(b.stats.likes);
-    });
-}
-//-----------------------------------------------------------------------
-const VideoStudy::Videos::const_iterator VideoStudy::most_controversial() const
+VideoStudy::Row VideoStudy::most_liked() const
 {
-  return std::max_element(m_videos.begin(), m_videos.end(),
-    [](const Video& a, const Video& b)
-    {
-      return std::stoi(a.stats.dislikes) < std::stoi(b.stats.dislikes);
-    });
+  return VideoTable::ArgMax(m_table.likes());
 }
 //-----------------------------------------------------------------------
-const VideoStudy::Videos::const_iterator VideoStudy::top_view_score() const
+VideoStudy::Row VideoStudy::most_controversial() const
 {
-  return std::max_element(m_videos.begin(), m_videos.end(),
-    [](const Video& a, const Video& b)
-    {
-      return a.stats.view_score < b.stats.view_score;
-    });
+  return VideoTable::ArgMax(m_table.dislikes());
 }
 //-----------------------------------------------------------------------
-const VideoStudy::Videos::const_iterator VideoStudy::top_like_score() const
+VideoStudy::Row VideoStudy::most_commented() const
 {
-  return std::max_element(m_videos.begin(), m_videos.end(),
-    [](const Video& a, const Video& b)
-    {
-      return a.stats.like_score < b.stats.like_score;
-    });
+  return VideoTable::ArgMax(m_table.comments());
 }
 //-----------------------------------------------------------------------
-const VideoStudy::Videos::const_iterator VideoStudy::top_dislike_score() const
+VideoStudy::Row VideoStudy::top_view_score() const
 {
-  return std::max_element(m_videos.begin(), m_videos.end(),
-    [](const Video& a, const Video& b)
-    {
-      return a.stats.dislike_score < b.stats.dislike_score;
-    });
+  return VideoTable::ArgMax(m_table.view_scores());
 }
 //-----------------------------------------------------------------------
-const VideoStudy::Videos::const_iterator VideoStudy::top_comment_score() const
+VideoStudy::Row VideoStudy::top_like_score() const
 {
-  return std::max_element(m_videos.begin(),m_videos.end(),
-    [](const Video& a, const Video& b)
-    {
-      return a.stats.comment_score < b.stats.comment_score;
-    });
+  return VideoTable::ArgMax(m_table.like_scores());
 }
 //-----------------------------------------------------------------------
-VideoStudy::Videos VideoStudy::get_videos()
+VideoStudy::Row VideoStudy::top_dislike_score() const
 {
-  return m_videos;
+  return VideoTable::ArgMax(m_table.dislike_scores());
 }
 //-----------------------------------------------------------------------
-double VideoStudy::compute_view_score(Video v)
+VideoStudy::Row VideoStudy::top_comment_score() const
 {
-  int     views   = std::stoi(v.stats.views);
-  int64_t delta_t = std::chrono::duration_cast<std::chrono::minutes>(
-    get_datetime_delta(get_simple_datetime(), v.datetime)).count();
-
-  return static_cast<double>(views * 1000 / delta_t);
+  return VideoTable::ArgMax(m_table.comment_scores());
 }
 //-----------------------------------------------------------------------
-double VideoStudy::compute_like_score(Video v)
+VideoStudy::Videos VideoStudy::get_videos() const
 {
-  return static_cast<double>(std::stof(v.stats.likes) / std::stof(v.stats.views));
+  return m_table.videos();
 }
 //-----------------------------------------------------------------------
-double VideoStudy::compute_dislike_score(Video v)
-{
-  return static_cast<double>(std::stof(v.stats.dislikes) / std::stof(v.stats.views));
-}
-//-----------------------------------------------------------------------
-double VideoStudy::compute_comment_score(Video v)
-{
-  return static_cast<double>(std::stof(v.stats.comments) / std::stof(v.stats.views));
-}
-//-----------------------------------------------------------------------
-VideoAnalyst::VideoAnalysis VideoAnalyst::get_analysis()
+const VideoAnalyst::VideoAnalysis& VideoAnalyst::get_analysis() const
 {
   return m_analysis;
 }
 //-----------------------------------------------------------------------
 void VideoAnalyst::analyze(StudyMap map)
 {
-  m_map = map;
+  m_analysis = VideoAnalysis{};
+  m_map      = std::move(map);
   for (auto&& [key, value] : m_map)
     m_analysis.map[key] = value.analyze();
 
   find_maximums();
 }
 //-----------------------------------------------------------------------
-void VideoAnalyst::find_maximums()
-{
-  using StudyResult = VideoStudy::VideoStudyResult;
-
-  const auto most_likes_index = std::max_element(m_analysis.map.begin(), m_analysis.map.end(),
-    [](const ResultPair& a, const ResultPair& b)
-    {
-      return std::stoi(a.second.most_likes->stats.likes) < std::stoi(b.second.most_likes->stats.likes);
-    });
-
-  if (most_likes_index != m_analysis.map.end())
-    m_analysis.most_likes_key = most_likes_index->first;
-
-  const auto most_dislikes_index = std::max_element(m_analysis.map.begin(), m_analysis.map.end(),
-    [](const ResultPair& a, const ResultPair& b)
-    {
-      return std::stoi(a.second.most_dislikes->stats.dislikes) < std::stoi(b.second.most_dislikes->stats.dislikes);
-    });
-
-  if (most_dislikes_index != m_analysis.map.end())
-    m_analysis.most_dislikes_key = most_dislikes_index->first;
-
-  const auto best_viewscore_index = std::max_element(m_analysis.map.begin(), m_analysis.map.end(),
-    [](const ResultPair& a, const ResultPair& b)
-    {
-      return a.second.top_view_score->stats.view_score < b.second.top_view_score->stats.view_score;
-    });
-
-  if (best_viewscore_index != m_analysis.map.end())
-    m_analysis.best_viewscore_key = best_viewscore_index->first;
-
-  const auto best_likescore_index = std::max_element(m_analysis.map.begin(), m_analysis.map.end(),
-    [](const ResultPair& a, const ResultPair& b)
-    {
-      return a.second.top_like_score->stats.like_score < b.second.top_like_score->stats.like_score;
-    });
-
-  if (best_likescore_index != m_analysis.map.end())
-    m_analysis.best_likescore_key = best_likescore_index->first;
+/**
+ * BestKey
+ *
+ * @param   [in]  {StudyMap}  studies
+ * @param   [in]  {ResultMap} results
+ * @param   [in]  {Row}       row    the result row to compare
+ * @param   [in]  {Column}    column the table column holding its value
+ * @returns [out] {std::string} key of the study whose row holds the largest value
+ */
+template <typename T>
+static std::string BestKey(const StudyMap&                                studies,
+                           const ResultMap&                               results,
+                           VideoStudy::Row VideoStudy::VideoStudyResult::* row,
+                           const std::vector<T>& (VideoTable::* column)() const)
+{
+  std::string key{};
+  T           best{};
+
+  for (const auto& [name, result] : results)
+  {
+    const VideoStudy::Row index = result.*row;
+    if (index == VideoTable::npos)
+      continue;
 
-  const auto best_dislikescore_index = std::max_element(m_analysis.map.begin(), m_analysis.map.end(),
-    [](const ResultPair& a, const ResultPair& b)
+    const T value = (studies.at(name).table().*column)()[index];
+    if (key.empty() || value > best)
     {
-      return a.second.top_dislike_score->stats.dislike_score < b.second.top_dislike_score->stats.dislike_score;
-    });
+      key  = name;
+      best = value;
+    }
+  }
 
-  if (best_dislikescore_index != m_analysis.map.end())
-    m_analysis.best_dislikescore_key = best_dislikescore_index->first;
+  return key;
+}
+//-----------------------------------------------------------------------
+void VideoAnalyst::find_maximums()
+{
+  using StudyResult = VideoStudy::VideoStudyResult;
 
-  const auto best_commentscore_index = std::max_element(m_analysis.map.begin(), m_analysis.map.end(),
-    [](const ResultPair& a, const ResultPair& b)
-    {
-      return a.second.top_comment_score->stats.comment_score < b.second.top_comment_score->stats.comment_score;
-    });
+  const ResultMap& results = m_analysis.map;
 
-  if (best_commentscore_index != m_analysis.map.end())
-    m_analysis.best_commentscore_key = best_commentscore_index->first;
+  m_analysis.most_likes_key        = BestKey(m_map, results, &StudyResult::most_likes,        &VideoTable::likes);
+  m_analysis.most_dislikes_key     = BestKey(m_map, results, &StudyResult::most_dislikes,     &VideoTable::dislikes);
+  m_analysis.most_comments_key     = BestKey(m_map, results, &StudyResult::most_comments,     &VideoTable::comments);
+  m_analysis.best_viewscore_key    = BestKey(m_map, results, &StudyResult::top_view_score,    &VideoTable::view_scores);
+  m_analysis.best_likescore_key    = BestKey(m_map, results, &StudyResult::top_like_score,    &VideoTable::like_scores);
+  m_analysis.best_dislikescore_key = BestKey(m_map, results, &StudyResult::top_dislike_score, &VideoTable::dislike_scores);
+  m_analysis.best_commentscore_key = BestKey(m_map, results, &StudyResult::top_comment_score, &VideoTable::comment_scores);
 }
 //-----------------------------------------------------------------------
 VideoCreatorComparison::VideoCreatorComparison(StudyMap study_map)
-: map(study_map) {}
+: map(std::move(study_map)) {}
 //-----------------------------------------------------------------------
 void VideoCreatorComparison::analyze()
 {
-  analyst.analyze(map);
+  if (analyzed)
+    return;
+
+  analyst.analyze(std::move(map)); // The analyst keeps the studies its results refer to
+  analyzed = true;
 }
 //-----------------------------------------------------------------------
-VideoAnalyst::VideoAnalysis VideoCreatorComparison::get_result()
+const VideoAnalyst::VideoAnalysis& VideoCreatorComparison::get_result() const
 {
   return analyst.get_analysis();
 }
@@ -239,7 +187,7 @@ bool ContentComparator::add_content(std::string key, Videos videos)
   if (m_map.find(key) != m_map.end())
     return false;
 
-  m_map.insert({key, VideoStudy{videos}});
+  m_map.try_emplace(std::move(key), std::move(videos));
   return true;
 }
 //-----------------------------------------------------------------------
@@ -249,5 +197,13 @@ const VideoCreatorComparison ContentComparator::analyze() const
   comparison.analyze();
   return comparison;
 }
+//-----------------------------------------------------------------------
+VideoCreatorComparison ContentComparator::take_analysis()
+{
+  VideoCreatorComparison comparison{std::move(m_map)};
+  m_map.clear();
+  comparison.analyze();
+  return comparison;
+}
 
 } // namespace ktube
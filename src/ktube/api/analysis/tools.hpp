@@ -5,6 +5,7 @@
 
 #include "process.hpp"
 #include "ktube/api/results.hpp"
+#include "video_table.hpp"
 
 namespace ktube {
 /**
@@ -14,7 +15,7 @@ namespace ktube {
 */
 kiq::ProcessResult execute(std::string program, std::vector<std::string> argv = {});
 
-std::vector<GoogleTrend> query_google_trends(std::vector<std::string> terms);
+std::vector<GoogleTrend> query_google_trends(const std::vector<std::string>& terms);
 
 /**
  * Platform
@@ -37,35 +38,38 @@ public:
 class VideoStudy {
 public:
 using Videos = std::vector<Video>;
+using Row    = VideoTable::Row;
 
+/**
+ * VideoStudyResult
+ *
+ * Rows of the study's table, VideoTable::npos when there were no videos
+ */
 struct VideoStudyResult {
-Videos::const_iterator most_likes;
-Videos::const_iterator most_dislikes;
-Videos::const_iterator most_comments;
-Videos::const_iterator top_view_score;
-Videos::const_iterator top_like_score;
-Videos::const_iterator top_dislike_score;
-Videos::const_iterator top_comment_score;
+Row most_likes{VideoTable::npos};
+Row most_dislikes{VideoTable::npos};
+Row most_comments{VideoTable::npos};
+Row top_view_score{VideoTable::npos};
+Row top_like_score{VideoTable::npos};
+Row top_dislike_score{VideoTable::npos};
+Row top_comment_score{VideoTable::npos};
 };
 
 VideoStudy(Videos videos);
 
 const VideoStudyResult analyze();
-const Videos::const_iterator most_liked() const;
-const Videos::const_iterator most_controversial() const;
-const Videos::const_iterator top_view_score() const;
-const Videos::const_iterator top_like_score() const;
-const Videos::const_iterator top_dislike_score() const;
-const Videos::const_iterator top_comment_score() const;
-Videos get_videos();
+Row               most_liked()         const;
+Row               most_controversial() const;
+Row               most_commented()     const;
+Row               top_view_score()     const;
+Row               top_like_score()     const;
+Row               top_dislike_score()  const;
+Row               top_comment_score()  const;
+const VideoTable& table()              const { return m_table; }
+Videos            get_videos()         const;
 
 private:
-double compute_view_score(Video v);
-double compute_like_score(Video v);
-double compute_dislike_score(Video v);
-double compute_comment_score(Video v);
-
-Videos m_videos;
+VideoTable m_table;
 };
 
 using StudyMap   = std::unordered_map<std::string, VideoStudy>;
@@ -85,7 +89,7 @@ public:
  * @struct
  */
 struct VideoAnalysis {
-ResultMap get_result_map() {
+const ResultMap& get_result_map() const {
   return map;
 }
 
@@ -116,8 +120,8 @@ std::string best_viewscore_channel_name() {
 ResultMap map;
 };
 
-VideoAnalysis get_analysis();
-void          analyze(StudyMap map);
+const VideoAnalysis& get_analysis() const;
+void                 analyze(StudyMap map);
 
 private:
 void find_maximums();
@@ -132,12 +136,13 @@ using VideoAnalysis = VideoAnalyst::VideoAnalysis;
 
 VideoCreatorComparison(StudyMap study_map);
 
-void          analyze();
-VideoAnalysis get_result();
+void                 analyze();
+const VideoAnalysis& get_result() const;
 
 private:
 VideoAnalyst analyst;
 StudyMap     map;
+bool         analyzed{false};
 };
 
 
@@ -148,6 +153,7 @@ public:
 virtual Platform get_type() override;
 bool add_content(std::string key, Videos videos);
 const VideoCreatorComparison analyze() const;
+VideoCreatorComparison       take_analysis();
 
 private:
 StudyMap m_map;
@@ -0,0 +1,120 @@
+#include "video_table.hpp"
+
+namespace ktube {
+VideoTable::VideoTable(std::vector<Video> videos)
+{
+  reserve(videos.size());
+  for (auto& video : videos)
+    add(std::move(video));
+}
+//-----------------------------------------------------------------------
+void VideoTable::reserve(const std::size_t size)
+{
+  m_channels      .reserve(size);
+  m_views         .reserve(size);
+  m_likes         .reserve(size);
+  m_dislikes      .reserve(size);
+  m_comments      .reserve(size);
+  m_published     .reserve(size);
+  m_view_scores   .reserve(size);
+  m_like_scores   .reserve(size);
+  m_dislike_scores.reserve(size);
+  m_comment_scores.reserve(size);
+  m_keyword_scores.reserve(size);
+  m_ids           .reserve(size);
+  m_titles        .reserve(size);
+  m_descriptions  .reserve(size);
+  m_datetimes     .reserve(size);
+  m_times         .reserve(size);
+  m_urls          .reserve(size);
+  m_keywords      .reserve(size);
+  m_trends        .reserve(size);
+}
+//-----------------------------------------------------------------------
+VideoTable::Row VideoTable::add(Video video)
+{
+  VideoStats& stats = video.stats;
+
+  m_channels      .push_back(m_channel_ids.intern(video.channel_id));
+  m_views         .push_back(stats.views);
+  m_likes         .push_back(stats.likes);
+  m_dislikes      .push_back(stats.dislikes);
+  m_comments      .push_back(stats.comments);
+  m_published     .push_back(to_epoch_ms(video.datetime));
+  m_view_scores   .push_back(stats.view_score);
+  m_like_scores   .push_back(stats.like_score);
+  m_dislike_scores.push_back(stats.dislike_score);
+  m_comment_scores.push_back(stats.comment_score);
+  m_keyword_scores.push_back(stats.keyword_score);
+  m_ids           .emplace_back(std::move(video.id));
+  m_titles        .emplace_back(std::move(video.title));
+  m_descriptions  .emplace_back(std::move(video.description));
+  m_datetimes     .emplace_back(std::move(video.datetime));
+  m_times         .emplace_back(std::move(video.time));
+  m_urls          .emplace_back(std::move(video.url));
+  m_keywords      .emplace_back(std::move(stats.keywords));
+  m_trends        .emplace_back(std::move(stats.trends));
+
+  return size() - 1;
+}
+//-----------------------------------------------------------------------
+Video VideoTable::video(const Row row) const
+{
+  Video video{
+    .channel_id  = std::string{channel(row)},
+    .id          = m_ids[row],
+    .title       = m_titles[row],
+    .description = m_descriptions[row],
+    .datetime    = m_datetimes[row],
+    .time        = m_times[row],
+    .url         = m_urls[row]
+  };
+
+  VideoStats& stats   = video.stats;
+  stats.views         = m_views[row];
+  stats.likes         = m_likes[row];
+  stats.dislikes      = m_dislikes[row];
+  stats.comments      = m_comments[row];
+  stats.keywords      = m_keywords[row];
+  stats.view_score    = m_view_scores[row];
+  stats.like_score    = m_like_scores[row];
+  stats.dislike_score = m_dislike_scores[row];
+  stats.comment_score = m_comment_scores[row];
+  stats.trends        = m_trends[row];
+  stats.keyword_score = m_keyword_scores[row];
+
+  return video;
+}
+//-----------------------------------------------------------------------
+std::vector<Video> VideoTable::videos() const
+{
+  std::vector<Video> videos{};
+  videos.reserve(size());
+  for (Row row = 0; row < size(); row++)
+    videos.emplace_back(video(row));
+  return videos;
+}
+//-----------------------------------------------------------------------
+void VideoTable::score(const int64_t now)
+{
+  for (Row row = 0; row < size(); row++)
+  {
+    const int64_t minutes = (m_published[row]) ? (now - m_published[row]) / 60000 : 0;
+    m_view_scores[row]    = (minutes > 0) ? static_cast<double>(m_views[row] * 1000 / minutes) : 0.0;
+  }
+
+  for (Row row = 0; row < size(); row++)
+  {
+    const double views     = static_cast<double>(m_views[row]);
+    m_like_scores[row]     = (m_views[row]) ? m_likes[row]    / views : 0.0;
+    m_dislike_scores[row]  = (m_views[row]) ? m_dislikes[row] / views : 0.0;
+    m_comment_scores[row]  = (m_views[row]) ? m_comments[row] / views : 0.0;
+  }
+}
+//-----------------------------------------------------------------------
+void VideoTable::set_trends(const Row row, std::vector<GoogleTrend> trends)
+{
+  m_trends[row] = std::move(trends);
+}
+
+} // namespace ktube
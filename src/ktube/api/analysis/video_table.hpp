@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ktube/common/types.hpp"
+#include "ktube/common/interactions.hpp"
+
+namespace ktube {
+/**
+ * VideoTable
+ *
+ * Videos stored column by column. Each numeric field that analysis scans
+ * (counts, publish time, scores) is its own contiguous vector, so a pass
+ * over one field reads only that field. Channel ids are dictionary encoded
+ * as four byte codes. The text fields, keywords and trends are kept in
+ * separate cold columns so a Video converts in and out of the table
+ * unchanged.
+ */
+class VideoTable {
+public:
+using Row = std::size_t;
+static constexpr Row npos{SIZE_MAX};
+
+VideoTable() = default;
+explicit VideoTable(std::vector<Video> videos);
+
+void               reserve(const std::size_t size);
+Row                add(Video video);
+Video              video(const Row row) const;
+std::vector<Video> videos()             const;
+std::size_t        size()               const { return m_views.size(); }
+bool               empty()              const { return m_views.empty(); }
+
+/**
+ * score
+ *
+ * Computes the view, like, dislike and comment score columns.
+ *
+ * @param [in] {int64_t} now UTC milliseconds, the view score is views per 1000 minutes since publishing
+ */
+void score(const int64_t now);
+
+/**
+ * ArgMax
+ *
+ * @param   [in]  {std::vector<T>} column
+ * @returns [out] {Row} first row holding the largest value, npos if the column is empty
+ */
+template <typename T>
+static Row ArgMax(const std::vector<T>& column)
+{
+  Row best{npos};
+  for (Row row = 0; row < column.size(); row++)
+    if (best == npos || column[row] > column[best])
+      best = row;
+  return best;
+}
+
+std::string_view                channel(const Row row)  const { return m_channel_ids.at(m_channels[row]); }
+const std::vector<std::string>& keywords(const Row row) const { return m_keywords[row]; }
+void                            set_trends(const Row row, std::vector<GoogleTrend> trends);
+
+const std::vector<uint32_t>& channels()       const { return m_channels;       }
+const std::vector<uint64_t>& views()          const { return m_views;          }
+const std::vector<uint64_t>& likes()          const { return m_likes;          }
+const std::vector<uint64_t>& dislikes()       const { return m_dislikes;       }
+const std::vector<uint64_t>& comments()       const { return m_comments;       }
+const std::vector<int64_t>&  published()      const { return m_published;      }
+const std::vector<double>&   view_scores()    const { return m_view_scores;    }
+const std::vector<double>&   like_scores()    const { return m_like_scores;    }
+const std::vector<double>&   dislike_scores() const { return m_dislike_scores; }
+const std::vector<double>&   comment_scores() const { return m_comment_scores; }
+
+private:
+// hot
+std::vector<uint32_t> m_channels;
+std::vector<uint64_t> m_views;
+std::vector<uint64_t> m_likes;
+std::vector<uint64_t> m_dislikes;
+std::vector<uint64_t> m_comments;
+std::vector<int64_t>  m_published; // UTC milliseconds
+std::vector<double>   m_view_scores;
+std::vector<double>   m_like_scores;
+std::vector<double>   m_dislike_scores;
+std::vector<double>   m_comment_scores;
+std::vector<double>   m_keyword_scores;
+// cold
+InternTable                           m_channel_ids;
+std::vector<std::string>              m_ids;
+std::vector<std::string>              m_titles;
+std::vector<std::string>              m_descriptions;
+std::vector<std::string>              m_datetimes;
+std::vector<std::string>              m_times;
+std::vector<std::string>              m_urls;
+std::vector<std::vector<std::string>> m_keywords;
+std::vector<std::vector<GoogleTrend>> m_trends;
+};
+
+} // namespace ktube
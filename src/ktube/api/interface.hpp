@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ktube/common/types.hpp"
+#include "ktube/common/batch.hpp"
 
 namespace ktube {
 class SecureAPI {
@@ -15,18 +16,20 @@ class VideoAPI {
 public:
 virtual ~VideoAPI() {}
 
-virtual std::vector<Video>       get_videos() = 0;
-virtual bool                     has_videos() = 0;
-virtual bool                     fetch_channel_data() = 0;
-virtual std::vector<ChannelInfo> fetch_channel_info(std::string id_string) = 0;
-virtual bool                     fetch_channel_videos() = 0;
-virtual std::vector<VideoStats>  fetch_video_stats(std::string id_string) = 0;
-virtual std::vector<ChannelInfo> fetch_youtube_stats() = 0;
-virtual std::vector<Video>       fetch_rival_videos(Video video, uint8_t max_count) = 0;
-virtual std::vector<ChannelInfo> find_similar_videos(Video video) = 0;
-virtual std::vector<GoogleTrend> fetch_google_trends(std::vector<std::string> terms) = 0;
-virtual std::vector<TermInfo>    fetch_term_info(std::vector<std::string> terms) = 0;
-virtual std::vector<Video>       fetch_videos_by_terms(std::vector<std::string> terms) = 0;
+virtual std::vector<Video>              get_videos() = 0;
+virtual bool                            has_videos() = 0;
+virtual bool                            fetch_channel_data() = 0;
+virtual std::vector<ChannelInfo>        fetch_channel_info(const std::string& id_string) = 0;
+virtual ChannelInfoMap                  fetch_channel_info(const IDList& ids) = 0;
+virtual bool                            fetch_channel_videos() = 0;
+virtual std::vector<VideoStats>         fetch_video_stats(const std::string& id_string) = 0;
+virtual VideoStatsMap                   fetch_video_stats(const IDList& ids) = 0;
+virtual const std::vector<ChannelInfo>& fetch_youtube_stats() = 0;
+virtual std::vector<Video>              fetch_rival_videos(const Video& video, uint8_t max_count) = 0;
+virtual std::vector<ChannelInfo>        find_similar_videos(const Video& video) = 0;
+virtual std::vector<GoogleTrend>        fetch_google_trends(const std::vector<std::string>& terms) = 0;
+virtual std::vector<TermInfo>           fetch_term_info(const std::vector<std::string>& terms) = 0;
+virtual std::vector<Video>              fetch_videos_by_terms(const std::vector<std::string>& terms) = 0;
 };
 
 class CommentAPI {
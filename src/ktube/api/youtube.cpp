@@ -11,16 +11,28 @@ namespace ktube {
  *
  * Notes:
  * - Sets the channels upon which API functions will be performed
+ * - All requests, including token refresh, share one pool of persistent sessions
  *
  */
 YouTubeDataAPI::YouTubeDataAPI ()
-: m_channel_ids{
+: m_executor{m_sessions.size()},
+  m_authenticator{m_sessions},
+  m_channel_ids{
   constants::CHANNEL_IDS.at(constants::KSTYLEYO_CHANNEL_ID_INDEX),
   constants::CHANNEL_IDS.at(constants::WALKAROUNDWORLD_CHANNEL_ID_INDEX)
   },
+  m_chat_hub{[this](const std::string& chat_id) { return CreateChatPoller(chat_id); }, m_executor},
   m_greet_on_entry{false},
   m_test_mode{false},
-  m_retry_mode{false} {
+  m_retry_mode{false},
+  m_chat_capacity{ChatBuffer::DEFAULT_CAPACITY},
+  m_chat_max_age_ms{ChatBuffer::DEFAULT_MAX_AGE_MS},
+  m_outbox{[this](const std::string& chat_id, const std::string& text) { return send_chat_message(chat_id, text); },
+           OutboxPolicy{std::chrono::milliseconds{constants::youtube::DEFAULT_CHAT_SEND_INTERVAL_MS},
+                        constants::youtube::MAX_CHAT_MESSAGE_LENGTH,
+                        false}},
+  m_pipeline{[this](ChatBatch& batch, std::vector<ChatReply>& replies) { process_chat_batch(batch, replies); },
+             [this](const ChatReply& reply, ChatPipeline::Done done) { m_outbox.post(reply.chat_id, reply.text, std::move(done), true); }} {
   INIReader reader{constants::DEFAULT_CONFIG_PATH};
 
   if (reader.ParseError() < 0) {
@@ -47,6 +59,70 @@ YouTubeDataAPI::YouTubeDataAPI ()
     m_retry_mode = retry_mode.compare("true") == 0;
   }
 
+  m_retrier.set_enabled(m_retry_mode);
+
+  auto chat_capacity = reader.GetInteger(constants::KTUBE_CONFIG_SECTION, constants::YOUTUBE_CHAT_CAPACITY, 0);
+  if (chat_capacity > 0) {
+    m_chat_capacity = static_cast<std::size_t>(chat_capacity);
+  }
+
+  auto chat_max_age = reader.GetInteger(constants::KTUBE_CONFIG_SECTION, constants::YOUTUBE_CHAT_MAX_AGE, 0);
+  if (chat_max_age > 0) {
+    m_chat_max_age_ms = static_cast<int64_t>(chat_max_age) * 1000;
+  }
+
+  OutboxPolicy outbox = m_outbox.policy();
+
+  auto send_interval = reader.GetInteger(constants::KTUBE_CONFIG_SECTION, constants::YOUTUBE_CHAT_SEND_INTERVAL, 0);
+  if (send_interval > 0) {
+    outbox.interval = std::chrono::milliseconds{send_interval};
+  }
+
+  auto coalesce = reader.GetString(constants::KTUBE_CONFIG_SECTION, constants::YOUTUBE_CHAT_COALESCE, "");
+  if (!coalesce.empty()) {
+    outbox.coalesce = coalesce.compare("true") == 0;
+  }
+
+  m_outbox.set_policy(outbox);
+
+  auto interactions_path = reader.GetString(constants::KTUBE_CONFIG_SECTION, constants::YOUTUBE_INTERACTIONS_PATH, "");
+  if (!interactions_path.empty() && !m_interactions.open(interactions_path)) {
+    log("Unable to open interactions snapshot " + interactions_path);
+  }
+
+  if (!m_username.empty()) {
+    m_mentions.add(m_username, MentionType::name);
+  }
+
+  for (const auto& alias : SplitIDs(reader.GetString(constants::KTUBE_CONFIG_SECTION, constants::YOUTUBE_ALIASES, ""))) {
+    m_mentions.add(alias, MentionType::alias);
+  }
+
+  for (const auto& command : constants::youtube::CHAT_COMMANDS) {
+    m_mentions.add(command, MentionType::command);
+  }
+
+  for (const auto& keyword : SplitIDs(reader.GetString(constants::KTUBE_CONFIG_SECTION, constants::YOUTUBE_KEYWORDS, ""))) {
+    m_mentions.add(keyword, MentionType::keyword);
+  }
+
+  m_mentions.build();
+
+}
+
+/**
+ * @brief Destroy the YouTubeDataAPI object
+ *
+ * Notes:
+ * - Chat threads are stopped before the buffers and matcher they use go away
+ * - The outbox is stopped while the pipeline it reports replies to is alive
+ *
+ */
+YouTubeDataAPI::~YouTubeDataAPI()
+{
+  m_chat_hub.stop();
+  m_pipeline.stop();
+  m_outbox.stop();
 }
 
 /**
@@ -71,12 +147,134 @@ bool YouTubeDataAPI::init(const bool fetch_fresh_token)
   return m_authenticator.FetchToken(fetch_fresh_token);
 }
 
-bool YouTubeDataAPI::fetch_channel_data() {
-  std::string id_string{};
-  for (const auto& channel_id : m_channel_ids) id_string += channel_id + ",";
+/**
+ * get
+ *
+ * Transient failures are retried under the given policy when retry mode is
+ * enabled in the config. The caller has charged the first attempt; each
+ * retry and hedge actually sent is charged under the same endpoint and
+ * priority, and is not sent if the quota refuses it.
+ *
+ * @param   [in]  {std::string}     url
+ * @param   [in]  {QueryParams}     params
+ * @param   [in]  {QuotaCharge}     charge
+ * @param   [in]  {cpr::Header}     header Sent in addition to the accept and auth headers
+ * @param   [in]  {RetryPolicy}     retry
+ * @returns [out] {RequestResponse}
+ */
+RequestResponse YouTubeDataAPI::get(const std::string& url,
+                                    const QueryParams& params,
+                                    const QuotaCharge& charge,
+                                    cpr::Header        header,
+                                    const RetryPolicy& retry)
+{
+  using namespace constants;
+
+  header.emplace(HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX));
+  header.emplace(HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token());
+
+  return RequestResponse{m_retrier.run(retry,
+    [this, full_url = ToURL(url, params), header] { return m_sessions.Get(cpr::Url{full_url}, header, cpr::Parameters{}); },
+    [this, charge] { return m_quota.acquire(charge.endpoint, charge.priority) == Admission::admit; })};
+}
+
+/**
+ * charge
+ *
+ * Charges one call. A paced call that is queued waits for its window on the
+ * caller's own thread; on an Executor worker it comes back as queued at once,
+ * so the worker stays free for live and reply calls.
+ *
+ * @param   [in]  {QuotaCharge} charge
+ * @returns [out] {Admission}
+ */
+Admission YouTubeDataAPI::charge(const QuotaCharge& charge)
+{
+  const std::chrono::seconds max_wait = (m_executor.in_worker()) ? QuotaManager::DEFAULT_WAIT : QuotaManager::MAX_WAIT;
+
+  return m_quota.acquire(charge.endpoint, charge.priority, max_wait);
+}
+
+/**
+ * charge_each
+ *
+ * Charges one call per input on the calling thread before a fan-out, so a
+ * queued call waits here rather than on a worker.
+ *
+ * @param   [in]  {std::vector<T>}  inputs
+ * @param   [in]  {QuotaCharge}     charge
+ * @returns [out] {std::vector<T*>} the inputs whose call was admitted
+ */
+template <typename T>
+std::vector<T*> YouTubeDataAPI::charge_each(std::vector<T>& inputs, const QuotaCharge& charge)
+{
+  std::vector<T*> admitted{};
+  admitted.reserve(inputs.size());
+
+  for (auto& input : inputs)
+    if (this->charge(charge) == Admission::admit)
+      admitted.push_back(&input);
+
+  return admitted;
+}
 
+/**
+ * get_cached
+ *
+ * Conditional GET: sends the cached etag as If-None-Match and returns the
+ * cached decoded value when the server answers 304 Not Modified. Otherwise
+ * the response is decoded and cached along with its new etag.
+ *
+ * @param   [in]  {std::string} url
+ * @param   [in]  {QueryParams} params
+ * @param   [in]  {QuotaCharge} charge
+ * @param   [in]  {F}           decode
+ * @returns [out] {T}
+ */
+template <typename T, typename F>
+T YouTubeDataAPI::get_cached(const std::string& url, const QueryParams& params, const QuotaCharge& charge, F&& decode)
+{
+  using namespace constants;
+
+  const std::string key = ToURL(url, params);
+  cpr::Header       header{};
+
+  if (const std::string etag = m_cache.etag(key); !etag.empty())
+    header.emplace(HEADER_NAMES.at(IF_NONE_MATCH_INDEX), etag);
+
+  RequestResponse response = get(url, params, charge, header);
+
+  if (response.not_modified())
+  {
+    if (std::optional<T> cached = m_cache.get<T>(key))
+      return std::move(*cached);
+
+    m_cache.erase(key);
+    if (this->charge(charge) != Admission::admit)
+      return T{};
+    response = get(url, params, charge);
+  }
+
+  if (response.error)
+    log("Error response from server:\n" + response.GetError());
+
+  T value = decode(response.text());
+
+  if (!response.error)
+    m_cache.put(key, response.etag(), value);
+
+  return value;
+}
+
+bool YouTubeDataAPI::fetch_channel_data() {
   try {
-    m_channels = fetch_channel_info(id_string);
+    ChannelInfoMap channels = fetch_channel_info(m_channel_ids);
+    m_channels.clear();
+
+    for (const auto& channel_id : m_channel_ids)
+      if (auto it = channels.find(channel_id); it != channels.end())
+        m_channels.emplace_back(std::move(it->second));
+
     return !(m_channels.empty());
   }
   catch (const std::exception& e) {
@@ -88,12 +286,13 @@ bool YouTubeDataAPI::fetch_channel_data() {
 /**
  * fetch_channel_videos
  *
+ * Searches every tracked channel concurrently
+ *
  * @return std::vector<VideoInfo>
  */
 bool YouTubeDataAPI::fetch_channel_videos()
 {
   using namespace constants;
-  using json = nlohmann::json;
 
   if (m_channels.empty()) {
     if (!fetch_channel_data()) {
@@ -102,66 +301,39 @@ bool YouTubeDataAPI::fetch_channel_videos()
     }
   }
 
-  for (ChannelInfo& channel : m_channels)
-    {
-      std::vector<Video> info_v{};
-
-      cpr::Response r = cpr::Get(
-        cpr::Url{URL_VALUES.at(SEARCH_URL_INDEX)},
-        cpr::Header{
-          {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-          {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}},
-        cpr::Parameters{
-          {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
-          {PARAM_NAMES.at(KEY_INDEX),        m_authenticator.get_key()},         // key
-          {PARAM_NAMES.at(CHAN_ID_INDEX),    channel.id},                        // channel id
-          {PARAM_NAMES.at(TYPE_INDEX),       PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
-          {PARAM_NAMES.at(ORDER_INDEX),      PARAM_VALUES.at(DATE_VALUE_INDEX)}, // order by
-          {PARAM_NAMES.at(MAX_RESULT_INDEX), std::to_string(5)}                  // limit
-        }//,
-        // cpr::VerifySsl{m_authenticator.verify_ssl()}
-      );
-
-      m_quota += youtube::QUOTA_LIMIT.at(youtube::SEARCH_LIST_QUOTA_INDEX);
-
-      json video_info = json::parse(r.text);
-
-      if (!video_info.is_null() && video_info.is_object())
-      {
-        auto items = video_info["items"];
-        if (!items.is_null() && items.is_array() && items.size() > 0)
-        {
-          for (const auto &item : items)
-          {
-            try
-            {
-              auto video_id = item["id"]["videoId"];
-              auto datetime = item["snippet"]["publishedAt"];
-
-              info_v.emplace_back(
-                Video{
-                  .channel_id  = item["snippet"]["channelId"],
-                  .id          = video_id,
-                  .title       = item["snippet"]["title"],
-                  .description = item["snippet"]["description"],
-                  .datetime    = datetime,
-                  .time        = to_readable_time(datetime),
-                  .url         = youtube_id_to_url(video_id)
-                }
-              );
-            }
-            catch (const std::exception &e)
-            {
-              std::string error_message{"Exception was caught: "};
-              error_message += e.what();
-              log(error_message);
-              return false;
-            }
-          }
-        }
-      }
-      channel.videos = info_v;
-    }
+  std::vector<ChannelInfo*> channels = charge_each(m_channels, {youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::standard});
+  const std::vector<bool>   results  = m_executor.map(channels,
+    [this](ChannelInfo* channel) { return fetch_channel_videos(*channel); });
+
+  return channels.size() == m_channels.size() &&
+         std::all_of(results.begin(), results.end(), [](const bool result) { return result; });
+}
+
+/**
+ * fetch_channel_videos
+ *
+ * The caller has charged the search
+ *
+ * @param   [in]  {ChannelInfo&} channel
+ * @returns [out] {bool}
+ */
+bool YouTubeDataAPI::fetch_channel_videos(ChannelInfo& channel)
+{
+  using namespace constants;
+
+  const QueryParams params{
+    {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
+    {PARAM_NAMES.at(FIELDS_INDEX),     FIELD_VALUES.at(SEARCH_VIDEO_FIELDS_INDEX)},
+    {PARAM_NAMES.at(KEY_INDEX),        m_authenticator.get_key()},         // key
+    {PARAM_NAMES.at(CHAN_ID_INDEX),    channel.id},                        // channel id
+    {PARAM_NAMES.at(TYPE_INDEX),       PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
+    {PARAM_NAMES.at(ORDER_INDEX),      PARAM_VALUES.at(DATE_VALUE_INDEX)}, // order by
+    {PARAM_NAMES.at(MAX_RESULT_INDEX), std::to_string(5)}                  // limit
+  };
+
+  RequestResponse response = get(URL_VALUES.at(SEARCH_URL_INDEX), params, {youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::standard});
+
+  channel.videos = DecodeVideoPage(response.text()).items;
 
   return true;
 }
@@ -169,74 +341,78 @@ bool YouTubeDataAPI::fetch_channel_videos()
 /**
  * fetch_video_stats
  *
+ * Positional variant: stats are returned in the order of the ids found
+ *
  * @param id_string
  * @return std::vector<VideoStats>
  */
-std::vector<VideoStats> YouTubeDataAPI::fetch_video_stats(std::string id_string)
+std::vector<VideoStats> YouTubeDataAPI::fetch_video_stats(const std::string& id_string)
 {
-  using namespace constants;
+  const IDList            ids       = UniqueIDs(SplitIDs(id_string));
+  VideoStatsMap           stats_map = fetch_video_stats(ids);
+  std::vector<VideoStats> stats{};
+  stats.reserve(stats_map.size());
 
-  using json = nlohmann::json;
+  for (const auto& id : ids)
+    if (const auto it = stats_map.find(id); it != stats_map.end())
+      stats.emplace_back(std::move(it->second));
 
-  std::vector<VideoStats> stats{};
+  return stats;
+}
 
-  cpr::Response r = cpr::Get(
-    cpr::Url{URL_VALUES.at(VIDEOS_URL_INDEX)},
-    cpr::Header{
-      {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-      {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}
-    },
-    cpr::Parameters{
-      {PARAM_NAMES.at(PART_INDEX),    VideoParamsFull()},
-      {PARAM_NAMES.at(KEY_INDEX),     m_authenticator.get_key()},
-      {PARAM_NAMES.at(ID_INDEX),      id_string}
-    }//,
-    // cpr::VerifySsl{m_authenticator.verify_ssl()}
-  );
+/**
+ * fetch_video_stats
+ *
+ * Duplicate ids are removed and the remainder is requested in chunks of
+ * MAX_IDS_PER_REQUEST, all in flight at once
+ *
+ * @param   [in]  {IDList}        ids
+ * @returns [out] {VideoStatsMap} keyed by video id
+ */
+VideoStatsMap YouTubeDataAPI::fetch_video_stats(const IDList& ids)
+{
+  using namespace constants;
 
-  m_quota += youtube::QUOTA_LIMIT.at(youtube::VIDEO_LIST_QUOTA_INDEX);
+  std::vector<std::string>   chunks   = ChunkIDs(UniqueIDs(ids));
+  std::vector<std::string*>  admitted = charge_each(chunks, {youtube::VIDEO_LIST_QUOTA_INDEX, QuotaPriority::standard});
+  std::vector<VideoStatsMap> results  = m_executor.map(admitted,
+    [this](const std::string* id_string) { return request_video_stats(*id_string); });
+  VideoStatsMap              stats{};
 
-  json video_info = json::parse(r.text);
+  for (auto& result : results)
+    stats.merge(result);
 
-  if (!video_info.is_null() && video_info.is_object())
-  {
-    auto items = video_info["items"];
-    if (!items.is_null() && items.is_array() && items.size())
-    {
-      for (int i = 0; i < items.size(); i++)
-      {
-        try
-        {
-          const auto &item = items.at(i);
-
-          stats.emplace_back(VideoStats{
-            .views = (item["statistics"].contains("viewCount")) ? item["statistics"]["viewCount"] : "0",
-            .likes = (item["statistics"].contains("likeCount")) ? item["statistics"]["likeCount"] : "0",
-            .dislikes = (item["statistics"].contains("dislikeCount")) ? item["statistics"]["dislikeCount"] : "0",
-            .comments = (item["statistics"].contains("commentCount")) ? item["statistics"]["commentCount"] : "0",
-            .keywords = (item["snippet"].contains("tags")) ?
-                          item["snippet"]["tags"].get<std::vector<std::string>>() :
-                          std::vector<std::string>{}
-          });
-        }
-        catch (const std::exception &e)
-        {
-          std::string error_message{"Exception was caught: "};
-          error_message += e.what();
-          log(error_message);
-        }
-      }
-    }
-  }
   return stats;
 }
 
+/**
+ * request_video_stats
+ *
+ * The caller has charged the request
+ *
+ * @param   [in]  {std::string}   id_string At most MAX_IDS_PER_REQUEST ids
+ * @returns [out] {VideoStatsMap}
+ */
+VideoStatsMap YouTubeDataAPI::request_video_stats(const std::string& id_string)
+{
+  using namespace constants;
+
+  const QueryParams params{
+    {PARAM_NAMES.at(PART_INDEX),    PARAM_VALUES.at(SNIPPET_STATS_INDEX)},
+    {PARAM_NAMES.at(FIELDS_INDEX),  FIELD_VALUES.at(VIDEO_STATS_FIELDS_INDEX)},
+    {PARAM_NAMES.at(KEY_INDEX),     m_authenticator.get_key()},
+    {PARAM_NAMES.at(ID_INDEX),      id_string}
+  };
+
+  return get_cached<VideoStatsMap>(URL_VALUES.at(VIDEOS_URL_INDEX), params, {youtube::VIDEO_LIST_QUOTA_INDEX, QuotaPriority::standard}, DecodeVideoStats);
+}
+
 /**
  * fetch_youtube_stats
  *
- * @returns [out] {std::vector<VideoInfo}
+ * @returns [out] {std::vector<ChannelInfo>} the channels held by the API, with their videos
  */
-std::vector<ChannelInfo> YouTubeDataAPI::fetch_youtube_stats()
+const std::vector<ChannelInfo>& YouTubeDataAPI::fetch_youtube_stats()
 {
   using namespace constants;
   using json = nlohmann::json;
@@ -244,22 +420,18 @@ std::vector<ChannelInfo> YouTubeDataAPI::fetch_youtube_stats()
   if (m_authenticator.is_authenticated() || m_authenticator.FetchToken())
   {
     if (fetch_channel_videos()) {
-      for (auto& channel : m_channels) {
-        std::string id_string{};
+      IDList ids{};
 
-        for (const auto &info : channel.videos) id_string += info.id + ",";
+      for (const auto& channel : m_channels)
+        for (const auto& video : channel.videos)
+          ids.emplace_back(video.id);
 
-        std::vector<VideoStats> stats = fetch_video_stats(id_string);
-        std::size_t             stats_size = stats.size();
+      VideoStatsMap stats = fetch_video_stats(ids);
 
-        if (stats_size == channel.videos.size())
-        {
-          for (uint8_t i = 0; i < stats_size; i++)
-          {
-            channel.videos.at(i).stats = stats.at(i);
-          }
-        }
-      }
+      for (auto& channel : m_channels)
+        for (auto& video : channel.videos)
+          if (const auto it = stats.find(video.id); it != stats.end())
+            video.stats = std::move(it->second);
     }
   }
 
@@ -269,16 +441,17 @@ std::vector<ChannelInfo> YouTubeDataAPI::fetch_youtube_stats()
 /**
  * fetch_rival_videos
  *
- * @param video
- * @return std::vector<VideoInfo>
+ * @param   [in]  {Video}   video
+ * @param   [in]  {uint8_t} max_count
+ * @returns [out] {std::vector<Video>}
  */
-std::vector<Video> YouTubeDataAPI::fetch_rival_videos(Video video, uint8_t max_count)
+std::vector<Video> YouTubeDataAPI::fetch_rival_videos(const Video& video, uint8_t max_count)
 {
   using namespace constants;
   using json = nlohmann::json;
 
   std::vector<Video> info_v{};
-  std::string        id_string{};
+  IDList             ids{};
   std::string        delim{};
 
   if (video.stats.keywords.empty()) // Nothing to search
@@ -292,72 +465,32 @@ std::vector<Video> YouTubeDataAPI::fetch_rival_videos(Video video, uint8_t max_c
     delim = '&';
   }
 
-  cpr::Response r = cpr::Get(
-    cpr::Url{URL_VALUES.at(SEARCH_URL_INDEX)},
-    cpr::Header{
-      {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-      {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}},
-    cpr::Parameters{
-      {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
-      {PARAM_NAMES.at(KEY_INDEX),        m_authenticator.get_key()},         // key
-      {PARAM_NAMES.at(QUERY_INDEX),      search_term},                       // query term
-      {PARAM_NAMES.at(TYPE_INDEX),       PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
-      {PARAM_NAMES.at(ORDER_INDEX),      PARAM_VALUES.at(VIEW_COUNT_INDEX)}, // order by
-      {PARAM_NAMES.at(MAX_RESULT_INDEX), std::to_string(max_count)}          // limit
-    }//,
-    // cpr::VerifySsl{m_authenticator.verify_ssl()}
-  );
+  if (charge({youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore}) != Admission::admit)
+    return info_v;
 
-  m_quota += youtube::QUOTA_LIMIT.at(youtube::SEARCH_LIST_QUOTA_INDEX);
+  const QueryParams params{
+    {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
+    {PARAM_NAMES.at(FIELDS_INDEX),     FIELD_VALUES.at(SEARCH_VIDEO_FIELDS_INDEX)},
+    {PARAM_NAMES.at(KEY_INDEX),        m_authenticator.get_key()},         // key
+    {PARAM_NAMES.at(QUERY_INDEX),      search_term},                       // query term
+    {PARAM_NAMES.at(TYPE_INDEX),       PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
+    {PARAM_NAMES.at(ORDER_INDEX),      PARAM_VALUES.at(VIEW_COUNT_INDEX)}, // order by
+    {PARAM_NAMES.at(MAX_RESULT_INDEX), std::to_string(max_count)}          // limit
+  };
 
-  json video_info = json::parse(r.text);
+  RequestResponse response = get(URL_VALUES.at(SEARCH_URL_INDEX), params, {youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore});
 
-  if (!video_info.is_null() && video_info.is_object())
-  {
-    auto items = video_info["items"];
-    if (!items.is_null() && items.is_array())
-    {
-      delim = "";
-      for (const auto &item : items)
-      {
-        try
-        {
-          auto video_id = item["id"]["videoId"];
-          auto datetime = item["snippet"]["publishedAt"];
-
-          Video info{
-              .channel_id  = item["snippet"]["channelId"],
-              .id          = video_id,
-              .title       = item["snippet"]["title"],
-              .description = item["snippet"]["description"],
-              .datetime    = datetime,
-              .time        = to_readable_time(datetime),
-              .url         = youtube_id_to_url(video_id)};
-
-          info_v.push_back(info);
-          id_string += delim + video_id.get<std::string>();
-          delim = ',';
-        }
-        catch (const std::exception &e)
-        {
-          std::string error_message{"Exception was caught: "};
-          error_message += e.what();
-          log(error_message);
-        }
-      }
-    }
-  }
+  info_v = DecodeVideoPage(response.text()).items;
 
-  std::vector<VideoStats> vid_stats = fetch_video_stats(id_string);
-  auto stats_size = vid_stats.size();
+  for (const auto& info : info_v)
+    ids.emplace_back(info.id);
+
+  VideoStatsMap vid_stats = fetch_video_stats(ids);
+
+  for (auto& info : info_v)
+    if (const auto it = vid_stats.find(info.id); it != vid_stats.end())
+      info.stats = std::move(it->second);
 
-  if (stats_size == info_v.size())
-  {
-    for (uint8_t i = 0; i < stats_size; i++)
-    {
-      info_v.at(i).stats = vid_stats.at(i);
-    }
-  }
   return info_v;
 }
 
@@ -367,60 +500,168 @@ std::vector<Video> YouTubeDataAPI::fetch_rival_videos(Video video, uint8_t max_c
  * @param   [in]  {VideoInfo}
  * @returns [out] {std::vector<ChannelInfo>}
  */
-std::vector<ChannelInfo> YouTubeDataAPI::find_similar_videos(Video video)
+std::vector<ChannelInfo> YouTubeDataAPI::find_similar_videos(const Video& video)
 {
-  std::vector<ChannelInfo> channels{};
-  std::vector<Video>   videos = fetch_rival_videos(video);
-
-  auto    it     = std::make_move_iterator(videos.begin());
-  auto    it_end = std::make_move_iterator(videos.end());
-  uint8_t idx{0};
-
-  while (it != it_end) {
-    auto chan_it = std::find_if(
-      channels.begin(), channels.end(),
-      [&it](const ChannelInfo& channel) {
-        return channel.id.compare(it->channel_id) == 0;
-      }
-    );
+  std::vector<ChannelInfo>                channels{};
+  std::unordered_map<std::string, size_t> index{};
+  std::vector<Video>                      videos = fetch_rival_videos(video);
+  IDList                                  channel_ids{};
+
+  channel_ids.reserve(videos.size());
+  for (const auto& rival : videos) channel_ids.emplace_back(rival.channel_id);
 
-    if (chan_it != channels.end()) {
-      chan_it->videos.emplace_back(std::move((*it)));
-    } else {
-      std::vector<ChannelInfo> channel_infos = fetch_channel_info(it->channel_id);
+  ChannelInfoMap channel_infos = fetch_channel_info(channel_ids);
 
-      if (!channel_infos.empty()) {
-        if (channel_infos.size() > 1) {
-          // TODO: Logger should note that this was a strange result
-        }
+  for (auto&& rival : videos) {
+    auto idx_it = index.find(rival.channel_id);
 
-        channels.emplace_back(std::move(channel_infos.front()));
-        channels.back().videos.emplace_back(std::move((*it)));
-      } else {
+    if (idx_it == index.end()) {
+      auto info_it = channel_infos.find(rival.channel_id);
+
+      if (info_it == channel_infos.end()) {
         // TODO: Unable to find channel. Strange
+        continue;
       }
+
+      idx_it = index.emplace(rival.channel_id, channels.size()).first;
+      channels.emplace_back(std::move(info_it->second));
     }
 
-    idx++;
-    it = std::make_move_iterator(videos.begin() + idx);
+    channels.at(idx_it->second).videos.emplace_back(std::move(rival));
   }
 
   return channels;
 }
 
+/**
+ * page_channel_videos
+ *
+ * Walks every upload of a channel, newest first, one search page at a time
+ *
+ * @param   [in]  {std::string}  channel_id
+ * @param   [in]  {std::size_t}  max_pages  0 for no limit
+ * @param   [in]  {bool}         prefetch   Request the following page in the background
+ * @returns [out] {Pager<Video>}
+ */
+Pager<Video> YouTubeDataAPI::page_channel_videos(const std::string& channel_id,
+                                                 const std::size_t  max_pages,
+                                                 const bool         prefetch)
+{
+  using namespace constants;
+
+  return Pager<Video>{
+    [this, channel_id](const std::string& page_token)
+    {
+      QueryParams params{
+        {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
+        {PARAM_NAMES.at(FIELDS_INDEX),     FIELD_VALUES.at(SEARCH_VIDEO_FIELDS_INDEX)},
+        {PARAM_NAMES.at(KEY_INDEX),        m_authenticator.get_key()},         // key
+        {PARAM_NAMES.at(CHAN_ID_INDEX),    channel_id},                        // channel id
+        {PARAM_NAMES.at(TYPE_INDEX),       PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
+        {PARAM_NAMES.at(ORDER_INDEX),      PARAM_VALUES.at(DATE_VALUE_INDEX)}, // order by
+        {PARAM_NAMES.at(MAX_RESULT_INDEX), std::to_string(youtube::MAX_SEARCH_RESULTS)}
+      };
+
+      if (!page_token.empty())
+        params.emplace(PARAM_NAMES.at(PAGE_TOKEN_INDEX), page_token);
+
+      if (const Admission admission = charge({youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::standard}); admission != Admission::admit)
+        return Page<Video>{{}, (admission == Admission::queue) ? page_token : ""}; // a queued page is asked for again
+
+      return DecodeVideoPage(get(URL_VALUES.at(SEARCH_URL_INDEX), params, {youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::standard}).text());
+    },
+    max_pages,
+    prefetch ? &m_executor : nullptr
+  };
+}
+
+/**
+ * page_videos_by_terms
+ *
+ * @param   [in]  {std::vector<std::string>} terms
+ * @param   [in]  {std::size_t}              max_pages 0 for no limit
+ * @param   [in]  {bool}                     prefetch  Request the following page in the background
+ * @returns [out] {Pager<Video>}
+ */
+Pager<Video> YouTubeDataAPI::page_videos_by_terms(const std::vector<std::string>& terms,
+                                                  const std::size_t               max_pages,
+                                                  const bool                      prefetch)
+{
+  using namespace constants;
+
+  std::string query{};
+  for (const auto& term : terms)
+    query += (query.empty() ? "" : "|") + term;
+
+  return Pager<Video>{
+    [this, query](const std::string& page_token)
+    {
+      QueryParams params{
+        {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
+        {PARAM_NAMES.at(FIELDS_INDEX),     FIELD_VALUES.at(SEARCH_VIDEO_FIELDS_INDEX)},
+        {PARAM_NAMES.at(KEY_INDEX),        m_authenticator.get_key()},         // key
+        {PARAM_NAMES.at(QUERY_INDEX),      query},                             // query terms
+        {PARAM_NAMES.at(TYPE_INDEX),       PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
+        {PARAM_NAMES.at(ORDER_INDEX),      PARAM_VALUES.at(VIEW_COUNT_INDEX)}, // order by
+        {PARAM_NAMES.at(MAX_RESULT_INDEX), std::to_string(youtube::MAX_SEARCH_RESULTS)}
+      };
+
+      if (!page_token.empty())
+        params.emplace(PARAM_NAMES.at(PAGE_TOKEN_INDEX), page_token);
+
+      if (const Admission admission = charge({youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore}); admission != Admission::admit)
+        return Page<Video>{{}, (admission == Admission::queue) ? page_token : ""}; // a queued page is asked for again
+
+      return DecodeVideoPage(get(URL_VALUES.at(SEARCH_URL_INDEX), params, {youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore}).text());
+    },
+    max_pages,
+    prefetch ? &m_executor : nullptr
+  };
+}
+
 /**
  * get_videos
+ *
+ * Copies the videos of every channel. Read them in place through channels(),
+ * or move them out with take_videos().
+ *
+ * @returns [out] {std::vector<Video>}
  */
 std::vector<Video> YouTubeDataAPI::get_videos()
 {
   std::vector<Video> videos{};
+  std::size_t        count{0};
+
+  for (const auto& channel : m_channels)
+    count += channel.videos.size();
+  videos.reserve(count);
+
+  for (const auto& channel : m_channels)
+    videos.insert(videos.end(), channel.videos.begin(), channel.videos.end());
+
+  return videos;
+}
 
-  for (const auto& channel : m_channels) {
-    videos.insert(
-      videos.end(),
-      channel.videos.begin(),
-      channel.videos.end()
-    );
+/**
+ * take_videos
+ *
+ * Moves the videos of every channel out, leaving the channels without videos
+ *
+ * @returns [out] {std::vector<Video>}
+ */
+std::vector<Video> YouTubeDataAPI::take_videos()
+{
+  std::vector<Video> videos{};
+  std::size_t        count{0};
+
+  for (const auto& channel : m_channels)
+    count += channel.videos.size();
+  videos.reserve(count);
+
+  for (auto& channel : m_channels)
+  {
+    std::move(channel.videos.begin(), channel.videos.end(), std::back_inserter(videos));
+    channel.videos.clear();
   }
 
   return videos;
@@ -443,7 +684,7 @@ bool YouTubeDataAPI::has_videos() {
  * @param   [in]  {std::vector<std::string>} terms
  * @returns [out] {std::vector<GoogleTrend>}
  */
-std::vector<GoogleTrend> YouTubeDataAPI::fetch_google_trends(std::vector<std::string> terms) {
+std::vector<GoogleTrend> YouTubeDataAPI::fetch_google_trends(const std::vector<std::string>& terms) {
   return query_google_trends(terms);
 }
 
@@ -453,7 +694,7 @@ std::vector<GoogleTrend> YouTubeDataAPI::fetch_google_trends(std::vector<std::st
  * @param terms
  * @return std::vector<VideoInfo>
  */
-std::vector<Video> YouTubeDataAPI::fetch_videos_by_terms(std::vector<std::string> terms) {
+std::vector<Video> YouTubeDataAPI::fetch_videos_by_terms(const std::vector<std::string>& terms) {
   using namespace constants;
   using json = nlohmann::json;
 
@@ -470,58 +711,25 @@ std::vector<Video> YouTubeDataAPI::fetch_videos_by_terms(std::vector<std::string
     }
   );
 
-  cpr::Response r = cpr::Get(
-    cpr::Url{URL_VALUES.at(SEARCH_URL_INDEX)},
-    cpr::Header{
-      {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-      {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}},
-    cpr::Parameters{
-      {PARAM_NAMES.at(PART_INDEX),           PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
-      {PARAM_NAMES.at(KEY_INDEX),            m_authenticator.get_key()},         // key
-      {PARAM_NAMES.at(QUERY_INDEX),          query},                             // query terms
-      {PARAM_NAMES.at(TYPE_INDEX),           PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
-      {PARAM_NAMES.at(ORDER_INDEX),          PARAM_VALUES.at(VIEW_COUNT_INDEX)}, // order by
-      {PARAM_NAMES.at(MAX_RESULT_INDEX),     std::to_string(5)}                  // limit
-    }//,
-    // cpr::VerifySsl{m_authenticator.verify_ssl()}
-  );
+  if (charge({youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore}) != Admission::admit)
+    return info_v;
 
-  m_quota += youtube::QUOTA_LIMIT.at(youtube::SEARCH_LIST_QUOTA_INDEX);
+  const QueryParams params{
+    {PARAM_NAMES.at(PART_INDEX),           PARAM_VALUES.at(SNIPPET_INDEX)},    // snippet
+    {PARAM_NAMES.at(FIELDS_INDEX),         FIELD_VALUES.at(SEARCH_VIDEO_FIELDS_INDEX)},
+    {PARAM_NAMES.at(KEY_INDEX),            m_authenticator.get_key()},         // key
+    {PARAM_NAMES.at(QUERY_INDEX),          query},                             // query terms
+    {PARAM_NAMES.at(TYPE_INDEX),           PARAM_VALUES.at(VIDEO_TYPE_INDEX)}, // type
+    {PARAM_NAMES.at(ORDER_INDEX),          PARAM_VALUES.at(VIEW_COUNT_INDEX)}, // order by
+    {PARAM_NAMES.at(MAX_RESULT_INDEX),     std::to_string(5)}                  // limit
+  };
 
-  json video_info = json::parse(r.text);
+  RequestResponse response = get(URL_VALUES.at(SEARCH_URL_INDEX), params, {youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore});
 
-  if (!video_info.is_null() && video_info.is_object())
-  {
-    auto items = video_info["items"];
-    if (!items.is_null() && items.is_array())
-    {
-      for (const auto &item : items)
-      {
-        try
-        {
-          auto video_id = item["id"]["videoId"];
-          auto datetime = item["snippet"]["publishedAt"];
-
-          Video info{
-            .channel_id  = PARAM_VALUES.at(CHAN_KEY_INDEX),
-            .id          = video_id,
-            .title       = item["snippet"]["title"],
-            .description = item["snippet"]["description"],
-            .datetime    = datetime,
-            .time        = to_readable_time(datetime),
-            .url         = youtube_id_to_url(video_id)};
-
-          info_v.push_back(info);
-        }
-        catch (const std::exception &e)
-        {
-          std::string error_message{"Exception was caught: "};
-          error_message += e.what();
-          log(error_message);
-        }
-      }
-    }
-  }
+  info_v = DecodeVideoPage(response.text()).items;
+
+  for (auto& info : info_v)
+    info.channel_id = PARAM_VALUES.at(CHAN_KEY_INDEX);
 
   return info_v;
 }
@@ -532,9 +740,8 @@ std::vector<Video> YouTubeDataAPI::fetch_videos_by_terms(std::vector<std::string
  * @param terms
  * @return std::vector<TermInfo>
  */
-std::vector<TermInfo> YouTubeDataAPI::fetch_term_info(std::vector<std::string> terms) {
+std::vector<TermInfo> YouTubeDataAPI::fetch_term_info(const std::vector<std::string>& terms) {
   using namespace constants;
-  const char delimiter{','};
 
   std::vector<TermInfo> metadata_v{};
 
@@ -543,28 +750,21 @@ std::vector<TermInfo> YouTubeDataAPI::fetch_term_info(std::vector<std::string> t
     std::vector<Video> videos = fetch_videos_by_terms(terms);
 
     if (!videos.empty()) {
-    std::string                                    id_string{};
-    std::vector<Video>::const_iterator it = videos.cbegin();
+    IDList ids{};
+    ids.reserve(videos.size());
 
-    id_string.reserve(videos.size() * youtube::YOUTUBE_VIDEO_ID_LENGTH);
-    id_string += (*it).id;
+    for (const auto& video : videos) ids.emplace_back(video.id);
 
-    while (++it != videos.cend()) id_string += delimiter + (*it).id;
+    VideoStatsMap stats = fetch_video_stats(ids);
 
-    std::vector<VideoStats> stats = fetch_video_stats(id_string);
-
-    if (stats.size() == videos.size())
-    {
-      for (uint8_t i = 0; i < stats.size(); i++)
-      {
-        videos.at(i).stats = stats.at(i);
-      }
-    }
+    for (auto& video : videos)
+      if (const auto it = stats.find(video.id); it != stats.end())
+        video.stats = std::move(it->second);
 
     int score{};
 
     for (const auto& video : videos) {
-      if (std::stoi(video.stats.views) > 100)
+      if (video.stats.views > 100)
         score ++;
     }
 
@@ -579,69 +779,82 @@ std::vector<TermInfo> YouTubeDataAPI::fetch_term_info(std::vector<std::string> t
   return metadata_v;
 }
 
-std::vector<ChannelInfo> YouTubeDataAPI::fetch_channel_info(std::string id_string) {
+/**
+ * fetch_channel_info
+ *
+ * Positional variant: channels are returned in the order of the ids found
+ *
+ * @param   [in]  {std::string}              id_string
+ * @returns [out] {std::vector<ChannelInfo>}
+ */
+std::vector<ChannelInfo> YouTubeDataAPI::fetch_channel_info(const std::string& id_string) {
+  const IDList             ids      = UniqueIDs(SplitIDs(id_string));
+  ChannelInfoMap           channels = fetch_channel_info(ids);
+  std::vector<ChannelInfo> info_v{};
+  info_v.reserve(channels.size());
+
+  for (const auto& id : ids)
+    if (auto it = channels.find(id); it != channels.end())
+      info_v.emplace_back(std::move(it->second));
+
+  return info_v;
+}
+
+/**
+ * fetch_channel_info
+ *
+ * Duplicate ids are removed and the remainder is requested in chunks of
+ * MAX_IDS_PER_REQUEST, all in flight at once
+ *
+ * @param   [in]  {IDList}         ids
+ * @returns [out] {ChannelInfoMap} keyed by channel id
+ */
+ChannelInfoMap YouTubeDataAPI::fetch_channel_info(const IDList& ids) {
   using namespace constants;
-  using json = nlohmann::json;
 
-  bool  NO_EXCEPTIONS_THROWN{false};
+  std::vector<std::string>    chunks   = ChunkIDs(UniqueIDs(ids));
+  std::vector<std::string*>   admitted = charge_each(chunks, {youtube::CHANNEL_LIST_QUOTA_INDEX, QuotaPriority::standard});
+  std::vector<ChannelInfoMap> results  = m_executor.map(admitted,
+    [this](const std::string* id_string) { return request_channel_info(*id_string); });
+  ChannelInfoMap              channels{};
 
-  std::vector<ChannelInfo> info_v{};
+  for (auto& result : results)
+    channels.merge(result);
 
-  cpr::Response r = cpr::Get(
-    cpr::Url{URL_VALUES.at(CHANNELS_URL_INDEX)},
-    cpr::Header{
-      {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-      {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}},
-    cpr::Parameters{
-      {PARAM_NAMES.at(PART_INDEX),           PARAM_VALUES.at(SNIPPET_STATS_INDEX)}, // snippet
-      {PARAM_NAMES.at(KEY_INDEX),            m_authenticator.get_key()},            // key
-      {PARAM_NAMES.at(ID_INDEX),             id_string},                            // query term
-      {PARAM_NAMES.at(TYPE_INDEX),           PARAM_VALUES.at(VIDEO_TYPE_INDEX)},    // type
-      {PARAM_NAMES.at(ORDER_INDEX),          PARAM_VALUES.at(VIEW_COUNT_INDEX)},    // order by
-      {PARAM_NAMES.at(MAX_RESULT_INDEX),     std::to_string(5)}                     // limit
-    }//,
-    // cpr::VerifySsl{m_authenticator.verify_ssl()}
-  );
+  return channels;
+}
 
-  m_quota += youtube::QUOTA_LIMIT.at(youtube::SEARCH_LIST_QUOTA_INDEX);
-
-  json channel_json = json::parse(r.text, nullptr, NO_EXCEPTIONS_THROWN);
-
-  if (!channel_json.is_null() && channel_json.is_object() && channel_json.contains("items")) {
-    json items = channel_json["items"];
-
-    // TODO: Combine follower counts with channel info
-    if (!items.is_null() && items.is_array()) {
-      for (const auto& item : items) {
-        info_v.emplace_back(
-          ChannelInfo{
-            .name          = item["snippet"]["title"],
-            .description   = item["snippet"]["description"],
-            .created       = item["snippet"]["publishedAt"],
-            .thumb_url     = item["snippet"]["thumbnails"]["default"]["url"],
-            .stats         = ChannelStats{
-                .views       = item["statistics"]["viewCount"],
-                .subscribers = (item["statistics"].contains("subscriberCount")) ?
-                                std::string{item["statistics"]["subscriberCount"]} :
-                                std::to_string(0),
-                .videos      = item["statistics"]["videoCount"]
-            },
-            .id            = item["id"]
-          }
-        );
-      }
-    }
-  }
+/**
+ * request_channel_info
+ *
+ * The caller has charged the request
+ *
+ * @param   [in]  {std::string}    id_string At most MAX_IDS_PER_REQUEST ids
+ * @returns [out] {ChannelInfoMap}
+ */
+ChannelInfoMap YouTubeDataAPI::request_channel_info(const std::string& id_string) {
+  using namespace constants;
 
-  return info_v;
+  const QueryParams params{
+    {PARAM_NAMES.at(PART_INDEX),           PARAM_VALUES.at(SNIPPET_STATS_INDEX)}, // snippet
+    {PARAM_NAMES.at(FIELDS_INDEX),         FIELD_VALUES.at(CHANNEL_INFO_FIELDS_INDEX)},
+    {PARAM_NAMES.at(KEY_INDEX),            m_authenticator.get_key()},            // key
+    {PARAM_NAMES.at(ID_INDEX),             id_string},                            // query term
+    {PARAM_NAMES.at(TYPE_INDEX),           PARAM_VALUES.at(VIDEO_TYPE_INDEX)},    // type
+    {PARAM_NAMES.at(ORDER_INDEX),          PARAM_VALUES.at(VIEW_COUNT_INDEX)},    // order by
+    {PARAM_NAMES.at(MAX_RESULT_INDEX),     std::to_string(youtube::MAX_IDS_PER_REQUEST)} // limit
+  };
+
+  return get_cached<ChannelInfoMap>(URL_VALUES.at(CHANNELS_URL_INDEX), params, {youtube::CHANNEL_LIST_QUOTA_INDEX, QuotaPriority::standard}, DecodeChannelInfo);
 }
+
 /**
  * get_quota_used
  *
  * @returns [out] {uint32_t}
  */
 const uint32_t YouTubeDataAPI::get_quota_used() const {
-  return m_quota;
+  return m_quota.used();
 }
 
 } // namespace ktube
@@ -11,6 +11,18 @@
 #include "interface.hpp"
 #include "nlp/nlp.hpp"
 #include "ktube/auth/auth.hpp"
+#include "ktube/common/executor.hpp"
+#include "ktube/common/cache.hpp"
+#include "ktube/common/quota.hpp"
+#include "ktube/common/retry.hpp"
+#include "ktube/common/chat_buffer.hpp"
+#include "ktube/common/chat_hub.hpp"
+#include "ktube/common/chat_pipeline.hpp"
+#include "ktube/common/outbox.hpp"
+#include "ktube/common/interactions.hpp"
+#include "ktube/common/recorder.hpp"
+#include "ktube/common/mention.hpp"
+#include "ktube/common/tokenizer.hpp"
 #include "analysis/html.hpp"
 #include "analysis/tools.hpp"
 
@@ -21,6 +33,10 @@ const std::string CreatePersonResponse(std::string name);
 const std::string CreateOrganizationResponse(std::string name);
 const std::string CreatePromoteResponse(bool test_mode = false);
 
+using ChatResponder = std::function<std::string(const std::string&               chat_id,
+                                                const LiveMessage&               message,
+                                                const std::vector<MentionMatch>& matches)>;
+
 class YouTubeDataAPI : public SecureAPI,
                        public VideoAPI,
                        public LiveAPI,
@@ -29,6 +45,7 @@ class YouTubeDataAPI : public SecureAPI,
 
 public:
   YouTubeDataAPI();
+  ~YouTubeDataAPI();
 
   virtual bool                     is_authenticated()                                     override;
   virtual bool                     init(const bool fetch_fresh_token = false)             override;
@@ -36,42 +53,77 @@ public:
 
   /** Analytics API **/
   virtual bool                     fetch_channel_data()                                   override;
-  virtual std::vector<ChannelInfo> fetch_channel_info(std::string id_string)              override;
+  virtual std::vector<ChannelInfo> fetch_channel_info(const std::string& id_string)       override;
+  virtual ChannelInfoMap           fetch_channel_info(const IDList& ids)                  override;
   virtual bool                     fetch_channel_videos()                                 override;
-  virtual std::vector<VideoStats>  fetch_video_stats(std::string id_string)               override;
-  virtual std::vector<ChannelInfo> fetch_youtube_stats()                                  override;
-  virtual std::vector<Video>       fetch_rival_videos(Video video, uint8_t max_count = 5) override;
-  virtual std::vector<ChannelInfo> find_similar_videos(Video video)                       override;
-          std::vector<Video>       get_videos();
-  virtual std::vector<GoogleTrend> fetch_google_trends(std::vector<std::string> terms)    override;
-  virtual std::vector<TermInfo>    fetch_term_info(std::vector<std::string> terms)        override;
-  virtual std::vector<Video>       fetch_videos_by_terms(std::vector<std::string> terms)  override;
+  virtual std::vector<VideoStats>  fetch_video_stats(const std::string& id_string)        override;
+  virtual VideoStatsMap            fetch_video_stats(const IDList& ids)                   override;
+  virtual const std::vector<ChannelInfo>& fetch_youtube_stats()                           override;
+  virtual std::vector<Video>       fetch_rival_videos(const Video& video, uint8_t max_count = 5) override;
+  virtual std::vector<ChannelInfo> find_similar_videos(const Video& video)                override;
+  virtual std::vector<Video>       get_videos()                                           override;
+          std::vector<Video>       take_videos();
+          const std::vector<ChannelInfo>& channels() const { return m_channels; }
+          Pager<Video>             page_channel_videos(const std::string& channel_id,
+                                                       const std::size_t  max_pages = 0,
+                                                       const bool         prefetch  = false);
+          Pager<Video>             page_videos_by_terms(const std::vector<std::string>& terms,
+                                                        const std::size_t               max_pages = 0,
+                                                        const bool                      prefetch  = false);
+  virtual std::vector<GoogleTrend> fetch_google_trends(const std::vector<std::string>& terms)   override;
+  virtual std::vector<TermInfo>    fetch_term_info(const std::vector<std::string>& terms)       override;
+  virtual std::vector<Video>       fetch_videos_by_terms(const std::vector<std::string>& terms) override;
 
     const uint32_t                 get_quota_used() const;
   /** Livechat API **/
   virtual std::string              FetchLiveVideoID()                                     override;
   virtual bool                     FetchLiveDetails()                                     override;
   virtual std::string              FetchChatMessages()                                    override;
+          Pager<LiveMessage>       PageChatMessages(std::string chat_id = "", const std::size_t max_pages = 0);
+          std::unique_ptr<ChatPoller> CreateChatPoller(std::string chat_id = "");
+          std::chrono::milliseconds   GetPollingInterval();
+          bool                     WatchChat(const std::string& chat_id);
+          bool                     WatchVideo(const std::string& video_id);
+          bool                     UnwatchChat(const std::string& chat_id);
+          std::size_t              PollChats();
+          ChatHub&                 GetChatHub() { return m_chat_hub; }
+          void                     StartChatPipeline(ChatResponder respond);
+          void                     StopChatPipeline();
+          PipelineStats            GetPipelineStats() const { return m_pipeline.stats(); }
+          OutboxStats              GetOutboxStats()   const { return m_outbox.stats();   }
+          bool                     StartRecording(const std::string& path) { return m_recorder.open(path); }
+          void                     StopRecording()                         { m_recorder.close();           }
+          ReplayStats              ReplayChat(const std::string& path,
+                                              const double       speed   = 1.0,
+                                              ChatResponder      respond = nullptr);
           std::string              GetUsername() { return m_username; }
-          VideoDetails             GetLiveDetails();
+          const VideoDetails&      GetLiveDetails() const { return m_video_details; }
           LiveChatMap              GetChats();
           LiveMessages             GetCurrentChat(bool keep_messages = false);
+          LiveMessages             GetChat(const std::string& chat_id);
+          LiveMessages             TakeChat(const std::string& chat_id);
+          const ChatBuffer*        GetChatBuffer(const std::string& chat_id) const;
+          const ChatStore&         GetChatStore() const { return m_chats; }
           LiveMessages             FindMentions(bool keep_messages = false);
+          std::vector<ChatMention> ScanMentions(const bool consume = true);
 
           bool                     FindChat();
           bool                     HasChats();
           bool                     ClearChat(std::string id = "");
-          bool                     PostMessage(std::string message);
-          bool                     ParseTokens();
-          bool                     InsertMessages(std::string id, LiveMessages&& messages);
+          bool                     PostMessage(std::string message, std::string chat_id = "");
+          std::future<bool>        PostMessageAsync(std::string message,
+                                                    std::string chat_id  = "",
+                                                    const bool  coalesce = false);
+          bool                     ParseTokens(std::string chat_id = "");
+          bool                     InsertMessages(const std::string& id, LiveMessages&& messages);
           bool                     GreetOnEntry();
-          bool                     HasInteracted(std::string id, Interaction interaction);
-          bool                     HasDiscussed(std::string value, Interaction type);
-          void                     RecordInteraction(std::string id,
-                                                     Interaction interaction,
-                                                     std::string value);
-          void                     SetChatMap(LiveChatMap chat_map) { m_chats = chat_map; }
-          void                     SetVideoDetails(VideoDetails video_details) { m_video_details = video_details; }
+          bool                     HasInteracted(const std::string_view id, Interaction interaction);
+          bool                     HasDiscussed(const std::string_view value, Interaction type);
+          void                     RecordInteraction(const std::string_view id,
+                                                     Interaction            interaction,
+                                                     const std::string_view value);
+          void                     SetChatMap(LiveChatMap chat_map);
+          void                     SetVideoDetails(VideoDetails video_details) { m_video_details = std::move(video_details); }
 /**
  * Comment API
  *
@@ -79,29 +131,59 @@ public:
 virtual   std::vector<Comment>     FetchVideoComments(const std::string& id) override;
 virtual   std::string              PostComment(const Comment& comment)       override;
 virtual   std::string              PostCommentReply(const Comment& comment)  override;
+          Pager<Comment>           PageVideoComments(const std::string& id,
+                                                     const std::size_t  max_pages = 0,
+                                                     const bool         prefetch  = false);
 
 protected:
-LiveChatMap  m_chats;
+ChatStore    m_chats;
+std::mutex   m_chats_mutex; // held to add or remove chats, and by the pipeline to look one up
 
 private:
-  bool                IsNewer(const char* datetime);
+  Admission           charge(const QuotaCharge& charge);
+  template <typename T>
+  std::vector<T*>     charge_each(std::vector<T>& inputs, const QuotaCharge& charge);
+  bool                fetch_channel_videos(ChannelInfo& channel);
+  VideoStatsMap       request_video_stats(const std::string& id_string);
+  ChannelInfoMap      request_channel_info(const std::string& id_string);
+  void                process_chat_batch(ChatBatch& batch, std::vector<ChatReply>& replies);
+  bool                send_chat_message(const std::string& chat_id, const std::string& text);
+  std::string         fetch_live_chat_id(const std::string& video_id);
+  ChatPoll            fetch_chat_poll(const std::string& chat_id, const std::string& page_token);
+  RequestResponse     get(const std::string& url,
+                          const QueryParams& params,
+                          const QuotaCharge& charge,
+                          cpr::Header        header = {},
+                          const RetryPolicy& retry  = RetryPolicy::Backoff());
+  template <typename T, typename F>
+  T                   get_cached(const std::string& url, const QueryParams& params, const QuotaCharge& charge, F&& decode);
 
+  SessionPool              m_sessions;
+  Retrier                  m_retrier;
+  Executor                 m_executor;
+  ResponseCache            m_cache;
   Authenticator            m_authenticator;
   std::vector<Video>       m_videos;
-  uint32_t                 m_quota;
+  QuotaManager             m_quota;
   std::vector<std::string> m_channel_ids;
   std::vector<ChannelInfo> m_channels;
   VideoDetails             m_video_details;
-  ActivityMap              m_interactions;
-  LocationMap              m_locations;
-  PersonMap                m_persons;
-  OrgMap                   m_orgs;
+  InteractionStore         m_interactions;
+  ChatRecorder             m_recorder;
   std::string              m_active_chat;
+  ChatHub                  m_chat_hub;
   std::string              m_username;
-  std::time_t              m_last_fetch_timestamp;
   bool                     m_greet_on_entry;
   bool                     m_test_mode;
   bool                     m_retry_mode;
+  MentionMatcher           m_mentions;
+  std::map<std::string, ChatBuffer::Cursor> m_mention_cursors;
+  std::map<std::string, ChatBuffer::Cursor> m_token_cursors;
+  std::size_t              m_chat_capacity;
+  int64_t                  m_chat_max_age_ms;
+  ChatResponder            m_responder;
+  ChatOutbox               m_outbox;
+  ChatPipeline             m_pipeline;
 };
 
 } // namespace ktube
@@ -14,23 +14,62 @@ std::vector<Comment> YouTubeDataAPI::FetchVideoComments(const std::string& id)
 {
   using namespace constants;
 
-  RequestResponse response{cpr::Get(
-    cpr::Url(URL_VALUES.at(COMMENT_THREADS_URL_INDEX)),
-    cpr::Header{
-      {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-      {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()     }
-    },
-    cpr::Parameters{
-      {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},
-      {PARAM_NAMES.at(VIDEO_ID_INDEX),   id                            },
-      {"order", "relevance"}
-    }
-  )};
+  if (charge({youtube::COMMENT_LIST_QUOTA_INDEX, QuotaPriority::standard}) != Admission::admit)
+    return std::vector<Comment>{};
+
+  const QueryParams params{
+    {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},
+    {PARAM_NAMES.at(FIELDS_INDEX),     FIELD_VALUES.at(COMMENT_THREAD_FIELDS_INDEX)},
+    {PARAM_NAMES.at(VIDEO_ID_INDEX),   id                            },
+    {"order", "relevance"}
+  };
+
+  RequestResponse response = get(URL_VALUES.at(COMMENT_THREADS_URL_INDEX), params, {youtube::COMMENT_LIST_QUOTA_INDEX, QuotaPriority::standard});
 
   if (response.error)
     log("Error response from server:\n" + response.GetError()); // Container will be empty
 
-  return ParseComments(response.json());
+  return DecodeCommentPage(response.text()).items;
+}
+
+/**
+ * @brief PageVideoComments
+ *
+ * @param   [in]  {std::string} id
+ * @param   [in]  {std::size_t} max_pages (optional) 0 for no limit
+ * @param   [in]  {bool}        prefetch  (optional)
+ * @returns [out] Pager<Comment>
+ */
+Pager<Comment> YouTubeDataAPI::PageVideoComments(const std::string& id, const std::size_t max_pages, const bool prefetch)
+{
+  using namespace constants;
+
+  return Pager<Comment>{
+    [this, id](const std::string& page_token)
+    {
+      QueryParams params{
+        {PARAM_NAMES.at(PART_INDEX),       PARAM_VALUES.at(SNIPPET_INDEX)},
+        {PARAM_NAMES.at(FIELDS_INDEX),     FIELD_VALUES.at(COMMENT_THREAD_FIELDS_INDEX)},
+        {PARAM_NAMES.at(VIDEO_ID_INDEX),   id                            },
+        {PARAM_NAMES.at(MAX_RESULT_INDEX), std::to_string(youtube::MAX_COMMENT_RESULTS)},
+        {"order", "relevance"}
+      };
+
+      if (!page_token.empty())
+        params.emplace(PARAM_NAMES.at(PAGE_TOKEN_INDEX), page_token);
+
+      if (const Admission admission = charge({youtube::COMMENT_LIST_QUOTA_INDEX, QuotaPriority::standard}); admission != Admission::admit)
+        return Page<Comment>{{}, (admission == Admission::queue) ? page_token : ""}; // a queued page is asked for again
+
+      RequestResponse response = get(URL_VALUES.at(COMMENT_THREADS_URL_INDEX), params, {youtube::COMMENT_LIST_QUOTA_INDEX, QuotaPriority::standard});
+      if (response.error)
+        log("Error response from server:\n" + response.GetError());
+
+      return DecodeCommentPage(response.text());
+    },
+    max_pages,
+    prefetch ? &m_executor : nullptr
+  };
 }
 
 // TODO: Return comment id
@@ -39,7 +78,10 @@ std::string YouTubeDataAPI::PostCommentReply(const Comment& comment)
   using namespace constants;
   std::string comment_id{};
 
-  RequestResponse response{cpr::Post(
+  if (charge({youtube::COMMENT_REPLY_QUOTA_INDEX, QuotaPriority::reply}) != Admission::admit)
+    return comment_id;
+
+  RequestResponse response{m_sessions.Post(
     cpr::Url(URL_VALUES.at(COMMENT_REPLY_URL_INDEX)),
     cpr::Header{
       {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
@@ -52,8 +94,6 @@ std::string YouTubeDataAPI::PostCommentReply(const Comment& comment)
     cpr::Body{comment.postdata()}
   )};
 
-  m_quota += youtube::QUOTA_LIMIT.at(youtube::COMMENT_INSERT_QUOTA_INDEX);
-
   if (response.error)
     log("Error response from server:\n" + response.GetError());
   else
@@ -72,7 +112,10 @@ std::string YouTubeDataAPI::PostComment(const Comment& comment)
   const bool  IS_NOT_REPLY{false};
   std::string comment_id{};
 
-  RequestResponse response{cpr::Post(
+  if (charge({youtube::COMMENT_INSERT_QUOTA_INDEX, QuotaPriority::reply}) != Admission::admit)
+    return comment_id;
+
+  RequestResponse response{m_sessions.Post(
     cpr::Url(URL_VALUES.at(COMMENT_THREADS_URL_INDEX)),
     cpr::Header{
       {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
@@ -85,8 +128,6 @@ std::string YouTubeDataAPI::PostComment(const Comment& comment)
     cpr::Body{comment.postdata(IS_NOT_REPLY)}
   )};
 
-  m_quota += youtube::QUOTA_LIMIT.at(youtube::COMMENT_INSERT_QUOTA_INDEX);
-
   if (response.error)
     log("Error response from server:\n" + response.GetError());
   else
@@ -32,6 +32,12 @@ std::string to_youtube_url(const std::string& id)
   return "https://www.youtube.com/watch?v=" + id;
 }
 
+static std::vector<Token> TokenizeMessage(const std::string& text)
+{
+  const std::string tokenized_text = conversation::TokenizeText(text);
+  return (tokenized_text.empty()) ? std::vector<Token>{} : conversation::SplitTokens(tokenized_text);
+}
+
  /**
    * FetchLiveVideoID
    *
@@ -40,203 +46,509 @@ std::string to_youtube_url(const std::string& id)
   std::string YouTubeDataAPI::FetchLiveVideoID() {
     using namespace constants;
 
-    cpr::Response r = cpr::Get(
-      cpr::Url{URL_VALUES.at(SEARCH_URL_INDEX)},
-      cpr::Header{
-        {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-        {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}
-      },
-      cpr::Parameters{
-        {PARAM_NAMES.at(PART_INDEX),    PARAM_VALUES.at(SNIPPET_INDEX)},
-        {PARAM_NAMES.at(KEY_INDEX),     m_authenticator.get_key()},
-        {PARAM_NAMES.at(CHAN_ID_INDEX), PARAM_VALUES.at(CHAN_KEY_INDEX)},
-        {PARAM_NAMES.at(EVENT_T_INDEX), PARAM_VALUES.at(LIVE_EVENT_TYPE_INDEX)},
-        {PARAM_NAMES.at(TYPE_INDEX),    PARAM_VALUES.at(VIDEO_TYPE_INDEX)}
-      }//,
-      // cpr::VerifySsl{m_authenticator.verify_ssl()}
-    );
+    if (charge({youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::live}) != Admission::admit)
+      return m_video_details.id;
 
-    json video_info = json::parse(r.text);
-
-    if (!video_info.is_null() && video_info.is_object()) {
-      auto items = video_info["items"];
-      if (!items.is_null() && items.is_array() && items.size() > 0) {
-        log(items[0]["snippet"].dump());
-        m_video_details.id = items[0]["id"]["videoId"];
-        SanitizeJSON(m_video_details.id);
-        m_video_details.title         = items[0]["snippet"]["title"];
-        m_video_details.description   = items[0]["snippet"]["description"];
-        m_video_details.channel_title = items[0]["snippet"]["channelTitle"];
-        m_video_details.channel_id    = items[0]["snippet"]["channelId"];
-        m_video_details.url           = to_youtube_url(m_video_details.id);
-        m_video_details.thumbnail     = (items[0]["snippet"].contains("thumbnails") &&
-                                        !items[0]["snippet"]["thumbnails"].is_null()) ?
-                                        items[0]["snippet"]["thumbnails"]["high"]["url"] :
-                                        "";
-      }
+    const QueryParams params{
+      {PARAM_NAMES.at(PART_INDEX),    PARAM_VALUES.at(SNIPPET_INDEX)},
+      {PARAM_NAMES.at(FIELDS_INDEX),  FIELD_VALUES.at(LIVE_VIDEO_FIELDS_INDEX)},
+      {PARAM_NAMES.at(KEY_INDEX),     m_authenticator.get_key()},
+      {PARAM_NAMES.at(CHAN_ID_INDEX), PARAM_VALUES.at(CHAN_KEY_INDEX)},
+      {PARAM_NAMES.at(EVENT_T_INDEX), PARAM_VALUES.at(LIVE_EVENT_TYPE_INDEX)},
+      {PARAM_NAMES.at(TYPE_INDEX),    PARAM_VALUES.at(VIDEO_TYPE_INDEX)}
+    };
+
+    RequestResponse response = get(URL_VALUES.at(SEARCH_URL_INDEX), params, {youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::live});
+
+    std::vector<VideoDetails> videos = DecodeVideoDetails(response.text()).items;
+
+    if (!videos.empty()) {
+      const std::string chat_id = std::move(m_video_details.chat_id);
+      m_video_details         = std::move(videos.front());
+      m_video_details.chat_id = chat_id;
+      m_video_details.url     = to_youtube_url(m_video_details.id);
       log("Fetched live video details for channel " + PARAM_VALUES.at(CHAN_KEY_INDEX));
     }
 
     return m_video_details.id;
   }
 
-  /**
-   * GetLiveDetails
-   *
-   * @returns [out] {VideoDetails}
-   */
-  VideoDetails YouTubeDataAPI::GetLiveDetails() {
-    return m_video_details;
-  }
-
   /**
    * FetchLiveDetails
    *
    * @returns [out] {bool}
    */
   bool YouTubeDataAPI::FetchLiveDetails() {
-    using namespace constants;
-
     if (m_video_details.id.empty()) {
       log("Unable to Fetch live details: no video ID");
       return false;
     }
 
-    cpr::Response r = cpr::Get(
-      cpr::Url{URL_VALUES.at(VIDEOS_URL_INDEX)},
-      cpr::Header{
-        {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-        {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}
-      },
-      // ,
-      cpr::Parameters{
-        {PARAM_NAMES.at(PART_INDEX),    PARAM_VALUES.at(LIVESTREAM_DETAILS_INDEX)},
-        {PARAM_NAMES.at(KEY_INDEX),     m_authenticator.get_key()},
-        {PARAM_NAMES.at(ID_INDEX),      m_video_details.id}
-      }//,
-      // cpr::VerifySsl{m_authenticator.verify_ssl()}
-    );
+    const std::string chat_id = fetch_live_chat_id(m_video_details.id);
+    if (chat_id.empty()) {
+      return false;
+    }
 
-    json live_info = json::parse(r.text);
+    m_video_details.chat_id = chat_id;
 
-    if (!live_info.is_null() && live_info.is_object()) {
-      auto items = live_info["items"];
-      if (!items.is_null() && items.is_array() && items.size() > 0) {
-        m_video_details.chat_id = kjson::GetJSONStringValue(items[0]["liveStreamingDetails"], "activeLiveChatId");
-        if (!m_video_details.chat_id.empty()) {
-          m_chats.insert({m_video_details.chat_id, std::vector<LiveMessage>{}});
-          log("Added chat details for " + m_video_details.chat_id);
-          return true;
-        }
-      }
+    {
+      std::lock_guard<std::mutex> lock{m_chats_mutex};
+      m_chats.try_emplace(m_video_details.chat_id, m_chat_capacity, m_chat_max_age_ms);
     }
-    return false;
+    log("Added chat details for " + m_video_details.chat_id);
+    return true;
+  }
+
+  /**
+   * fetch_live_chat_id
+   *
+   * @param   [in]  {std::string} video_id
+   * @returns [out] {std::string} active live chat of the video, empty if it has none
+   */
+  std::string YouTubeDataAPI::fetch_live_chat_id(const std::string& video_id) {
+    using namespace constants;
+
+    if (charge({youtube::VIDEO_LIST_QUOTA_INDEX, QuotaPriority::live}) != Admission::admit)
+      return "";
+
+    const QueryParams params{
+      {PARAM_NAMES.at(PART_INDEX),    PARAM_VALUES.at(LIVESTREAM_DETAILS_INDEX)},
+      {PARAM_NAMES.at(FIELDS_INDEX),  FIELD_VALUES.at(LIVE_DETAILS_FIELDS_INDEX)},
+      {PARAM_NAMES.at(KEY_INDEX),     m_authenticator.get_key()},
+      {PARAM_NAMES.at(ID_INDEX),      video_id}
+    };
+
+    RequestResponse response = get(URL_VALUES.at(VIDEOS_URL_INDEX), params, {youtube::VIDEO_LIST_QUOTA_INDEX, QuotaPriority::live});
+
+    const std::vector<VideoDetails> videos = DecodeVideoDetails(response.text()).items;
+    if (!videos.empty())
+      return videos.front().chat_id;
+
+    return "";
   }
 
   /**
    * FetchChatMessages
    *
-   * @returns [out] {std::string}
+   * One step of the chat long-poll. Messages that arrived since the previous
+   * poll are added to the current chat. Nothing is requested until the
+   * polling interval the server gave last time has passed.
+   *
+   * @returns [out] {std::string} token for the next poll, empty if no poll was due
    */
   std::string YouTubeDataAPI::FetchChatMessages() {
-  using namespace constants;
+    if (m_video_details.chat_id.empty()) {
+      log("Unable to fetch chat messages: no chat ID");
+      return "";
+    }
 
-    log("Fetching chat messages for " + m_video_details.chat_id);
+    const std::string chat_id = m_video_details.chat_id;
 
-    cpr::Response r = cpr::Get(
-      cpr::Url{URL_VALUES.at(LIVE_CHAT_URL_INDEX)},
-      cpr::Header{
-        {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
-        {HEADER_NAMES.at(AUTH_HEADER_INDEX),   m_authenticator.get_token()}
-      },
-      cpr::Parameters{
-        {PARAM_NAMES.at(PART_INDEX),           PARAM_VALUES.at(SNIPPET_INDEX)},
-        {PARAM_NAMES.at(KEY_INDEX),            m_authenticator.get_key()},
-        {PARAM_NAMES.at(LIVE_CHAT_ID_INDEX),   m_video_details.chat_id},
-      }//,
-      // cpr::VerifySsl{m_authenticator.verify_ssl()}
-    );
+    WatchChat(chat_id);
+
+    const std::shared_ptr<ChatPoller> poller = m_chat_hub.session(chat_id);
+    if (!poller || !poller->due())
+      return "";
+
+    log("Fetching chat messages for " + chat_id);
+
+    m_chat_hub.poll(chat_id);
+
+    return poller->page_token();
+  }
+
+  /**
+   * CreateChatPoller
+   *
+   * @param   [in]  {std::string}                 chat_id (optional) defaults to the current chat
+   * @returns [out] {std::unique_ptr<ChatPoller>}
+   */
+  std::unique_ptr<ChatPoller> YouTubeDataAPI::CreateChatPoller(std::string chat_id) {
+    chat_id = (chat_id.empty()) ? m_video_details.chat_id : chat_id;
+
+    return std::make_unique<ChatPoller>(
+      [this, chat_id](const std::string& page_token) { return fetch_chat_poll(chat_id, page_token); });
+  }
+
+  /**
+   * GetPollingInterval
+   *
+   * @returns [out] {std::chrono::milliseconds} wait the server asked for before the next chat poll
+   */
+  std::chrono::milliseconds YouTubeDataAPI::GetPollingInterval() {
+    const std::shared_ptr<ChatPoller> poller = m_chat_hub.session(m_video_details.chat_id);
 
-    json chat_info = json::parse(r.text);
+    return (poller) ?
+             poller->interval() :
+             std::chrono::milliseconds{constants::youtube::DEFAULT_CHAT_POLL_INTERVAL_MS};
+  }
+
+  /**
+   * WatchChat
+   *
+   * Adds a chat to the hub. Its messages are collected alongside every other
+   * watched chat, through the same sessions and quota, by PollChats() or by
+   * the hub's own loop once GetChatHub().start() is called.
+   *
+   * @param   [in]  {std::string} chat_id
+   * @returns [out] {bool} false if the chat was already watched
+   */
+  bool YouTubeDataAPI::WatchChat(const std::string& chat_id) {
+    if (chat_id.empty() || m_chat_hub.contains(chat_id))
+      return false;
 
-    if (!chat_info.is_null() && chat_info.is_object()) {
-      auto      items = chat_info["items"];
+    {
+      std::lock_guard<std::mutex> lock{m_chats_mutex};
+      m_chats.try_emplace(chat_id, m_chat_capacity, m_chat_max_age_ms);
+    }
 
+    return m_chat_hub.add(chat_id, [this, chat_id](const LiveMessages& messages) {
+      ChatBuffer::Cursor first{};
+      {
+        std::lock_guard<std::mutex> lock{m_chats_mutex};
+        const auto                  it = m_chats.find(chat_id);
+        if (it == m_chats.end()) // replaced by SetChatMap while this poll was in flight
+          return;
+        first = it->second.push(LiveMessages{messages});
+      }
 
-      if (!items.is_null() && items.is_array() && !items.empty()) {
-        for (const auto& item : items) {
+      if (m_pipeline.running())
+        m_pipeline.ingest(ChatBatch{chat_id, first, messages});
+    });
+  }
 
-          try {
-            auto details       = item.at("snippet").at("textMessageDetails");
-            std::string text   = (details.contains("messageText")) ?
-                                   details["messageText"] :
-                                   "";
+  /**
+   * StartChatPipeline
+   *
+   * Moves work off the polling path. Each poll hands its messages to a
+   * processing stage that tokenizes them and runs the mention matcher. Every
+   * message with a match goes to respond, and any text it returns is posted
+   * to that chat by a separate sending stage.
+   *
+   * @param   [in]  {ChatResponder} respond returns the reply, or an empty string for none
+   */
+  void YouTubeDataAPI::StartChatPipeline(ChatResponder respond) {
+    m_pipeline.stop();
+    m_responder = std::move(respond);
+    m_pipeline.start();
+  }
 
-            std::string author = item["snippet"]["authorChannelId"];
-            std::string time   = item["snippet"]["publishedAt"];
+  /**
+   * StopChatPipeline
+   */
+  void YouTubeDataAPI::StopChatPipeline() {
+    m_pipeline.stop();
+  }
 
-            // if (!IsNewer(time.c_str())) { // Ignore duplicates
-            //   continue; // FIX: This is a bug -> tie is always old -> timezone issues?
-            // }
+  /**
+   * process_chat_batch
+   *
+   * Tokenizes the batch's own copy of the messages on the executor and
+   * answers the ones with a mention. The tokens are then written back to
+   * the chat, which is looked up by id, and only into messages it still
+   * holds with the same id.
+   *
+   * @param   [in]  {ChatBatch}              batch
+   * @param   [out] {std::vector<ChatReply>} replies
+   */
+  void YouTubeDataAPI::process_chat_batch(ChatBatch& batch, std::vector<ChatReply>& replies) {
+    LiveMessages& messages = batch.messages;
 
-            // SanitizeJSON(text);
-            // SanitizeJSON(author);
-            // SanitizeJSON(time);
+    std::vector<std::vector<Token>> tokens = m_executor.map(messages, [](const LiveMessage& message) {
+      return TokenizeMessage(message.text);
+    });
 
-            m_chats.at(m_video_details.chat_id).push_back(
-              LiveMessage{
-                .timestamp = time,
-                .author    = author,
-                .text      = text
-              }
-            );
-          } catch (const std::exception& e) {
-            std::string error_message{"Exception was caught: "};
-            error_message += e.what();
-            log(error_message);
-          }
-        }
+    for (std::size_t i = 0; i < messages.size(); i++) {
+      messages[i].tokens    = std::move(tokens[i]);
+      messages[i].tokenized = true;
+    }
 
-        // if (!m_chats.at(m_video_details.chat_id).empty()) {
-        //   m_last_fetch_timestamp = to_unixtime(m_chats.at(m_video_details.chat_id).back().timestamp.c_str());
-        // }
+    if (m_responder) {
+      std::vector<MentionMatch> matches{};
+
+      for (const LiveMessage& message : messages) {
+        matches.clear();
+        m_mentions.scan(message.text, [&matches](const MentionMatch& match) { matches.push_back(match); });
+
+        if (matches.empty())
+          continue;
+
+        if (std::string reply = m_responder(batch.chat_id, message, matches); !reply.empty())
+          replies.push_back(ChatReply{batch.chat_id, std::move(reply)});
       }
     }
 
-    return r.text;
+    std::lock_guard<std::mutex> lock{m_chats_mutex};
+    const auto                  it = m_chats.find(batch.chat_id);
+    if (it == m_chats.end())
+      return;
+
+    for (std::size_t i = 0; i < messages.size(); i++)
+      it->second.at(batch.begin + i, [&messages, i](LiveMessage& held) {
+        if (held.tokenized || held.id != messages[i].id)
+          return;
+        held.tokens    = std::move(messages[i].tokens);
+        held.tokenized = true;
+      });
+  }
+
+  /**
+   * WatchVideo
+   *
+   * @param   [in]  {std::string} video_id
+   * @returns [out] {bool} false if the video has no active chat
+   */
+  bool YouTubeDataAPI::WatchVideo(const std::string& video_id) {
+    const std::string chat_id = fetch_live_chat_id(video_id);
+    if (chat_id.empty()) {
+      log("No active chat for " + video_id);
+      return false;
+    }
+
+    WatchChat(chat_id);
+
+    return true;
+  }
+
+  /**
+   * UnwatchChat
+   *
+   * Stops polling a chat. The messages already collected are kept. A poll of
+   * the chat already in flight may still deliver once. Safe to call from a
+   * responder.
+   *
+   * @param   [in]  {std::string} chat_id
+   * @returns [out] {bool}
+   */
+  bool YouTubeDataAPI::UnwatchChat(const std::string& chat_id) {
+    return m_chat_hub.remove(chat_id);
+  }
+
+  /**
+   * PollChats
+   *
+   * @returns [out] {std::size_t} new messages across every watched chat
+   */
+  std::size_t YouTubeDataAPI::PollChats() {
+    return m_chat_hub.poll();
+  }
+
+  /**
+   * fetch_chat_poll
+   *
+   * @param   [in]  {std::string} chat_id
+   * @param   [in]  {std::string} page_token
+   * @returns [out] {ChatPoll}
+   */
+  ChatPoll YouTubeDataAPI::fetch_chat_poll(const std::string& chat_id, const std::string& page_token) {
+    using namespace constants;
+
+    if (charge({youtube::LIVE_CHAT_LIST_QUOTA_INDEX, QuotaPriority::live}) != Admission::admit)
+      return ChatPoll{Page<LiveMessage>{}, std::chrono::milliseconds{youtube::DEFAULT_CHAT_POLL_INTERVAL_MS}};
+
+    QueryParams params{
+      {PARAM_NAMES.at(PART_INDEX),           PARAM_VALUES.at(SNIPPET_INDEX)},
+      {PARAM_NAMES.at(FIELDS_INDEX),         FIELD_VALUES.at(LIVE_CHAT_FIELDS_INDEX)},
+      {PARAM_NAMES.at(KEY_INDEX),            m_authenticator.get_key()},
+      {PARAM_NAMES.at(LIVE_CHAT_ID_INDEX),   chat_id}
+    };
+
+    if (!page_token.empty())
+      params.emplace(PARAM_NAMES.at(PAGE_TOKEN_INDEX), page_token);
+
+    RequestResponse response = get(URL_VALUES.at(LIVE_CHAT_URL_INDEX), params, {youtube::LIVE_CHAT_LIST_QUOTA_INDEX, QuotaPriority::live}, {}, RetryPolicy::Hedged());
+    if (response.error)
+      log("Error response from server:\n" + response.GetError());
+    else
+      m_recorder.append(chat_id, std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count(), response.response.text);
+
+    return DecodeChatPoll(response.text());
   }
 
-  bool YouTubeDataAPI::IsNewer(const char* datetime) {
-    return std::difftime(to_unixtime(datetime), m_last_fetch_timestamp) > 0;
+  /**
+   * PageChatMessages
+   *
+   * Walks the messages already in a chat. The walk ends at the first empty
+   * page, since liveChat always hands out a token for the next poll.
+   *
+   * @param   [in]  {std::string}        chat_id   (optional) defaults to the current chat
+   * @param   [in]  {std::size_t}        max_pages (optional) 0 for no limit
+   * @returns [out] {Pager<LiveMessage>}
+   */
+  Pager<LiveMessage> YouTubeDataAPI::PageChatMessages(std::string chat_id, const std::size_t max_pages) {
+    chat_id = (chat_id.empty()) ? m_video_details.chat_id : chat_id;
+
+    return Pager<LiveMessage>{
+      [this, chat_id](const std::string& page_token) {
+        Page<LiveMessage> page = fetch_chat_poll(chat_id, page_token).page;
+
+        if (page.items.empty())
+          page.next_page_token.clear();
+
+        return page;
+      },
+      max_pages
+    };
   }
 
   /**
-   * Parsetokens
+   * ParseTokens
    *
-   * @returns
+   * Tokenizes the messages of a chat that arrived since the last call, on the
+   * executor. Earlier messages keep the tokens they already have.
    *
+   * @param   [in]  {std::string} chat_id (optional) defaults to the current chat
+   * @returns [out] {bool} true if the oldest message held has tokens
    */
-  bool YouTubeDataAPI::ParseTokens() {
-    if (HasChats()) {
-      for (auto&& chat : m_chats.at(m_video_details.chat_id)) {
-        std::string tokenized_text = conversation::TokenizeText(chat.text);
+  bool YouTubeDataAPI::ParseTokens(std::string chat_id) {
+    chat_id = (chat_id.empty()) ? m_video_details.chat_id : chat_id;
+
+    const auto it = m_chats.find(chat_id);
+    if (it == m_chats.end() || it->second.empty())
+      return false;
 
-        if (!tokenized_text.empty()) {
-          chat.tokens = conversation::SplitTokens(tokenized_text);
+    ChatBuffer&         chat    = it->second;
+    ChatBuffer::Cursor& cursor  = m_token_cursors[chat_id];
+
+    cursor = TokenizeMessages(chat, cursor, m_executor, TokenizeMessage);
+
+    bool has_tokens{false};
+    chat.at(chat.begin(), [&has_tokens](const LiveMessage& message) { has_tokens = !message.tokens.empty(); });
+
+    return has_tokens;
+  }
+
+  /**
+   * ReplayChat
+   *
+   * Runs a recording made with StartRecording through the chat path the way
+   * live polls would: each response is parsed, passed through a MessageIndex
+   * per chat so repeated messages are dropped, inserted with InsertMessages,
+   * tokenized, scanned for mentions and, if respond is given, answered.
+   * Only the recorded chat is scanned, with cursors that belong to the
+   * replay, so live mention scans still see every message they have not
+   * consumed. Replies are counted but never posted. The current chat is left
+   * as it was.
+   *
+   * @param   [in]  {std::string}   path
+   * @param   [in]  {double}        speed   1 for real time, 100 for a hundred times faster, 0 for no waiting
+   * @param   [in]  {ChatResponder} respond (optional)
+   * @returns [out] {ReplayStats}   throughput and per-stage latency
+   */
+  ReplayStats YouTubeDataAPI::ReplayChat(const std::string& path, const double speed, ChatResponder respond) {
+    using Clock = std::chrono::steady_clock;
+
+    ReplayStats                                         stats{};
+    std::unordered_map<std::string, MessageIndex>       seen{};
+    std::unordered_map<std::string, ChatBuffer::Cursor> cursors{};
+    const auto                                          start = Clock::now();
+
+    stats.records = ChatReplay{path, speed}.run([this, &stats, &seen, &cursors, &respond](const ChatRecord& record) {
+      auto     stage = Clock::now();
+      ChatPoll poll  = DecodeChatPoll(record.body);
+      stats.parse.add(Clock::now() - stage);
+
+      stage = Clock::now();
+      MessageIndex& index = seen[record.chat_id];
+      LiveMessages  fresh{};
+      for (auto& message : poll.page.items)
+        if (index.insert(message))
+          fresh.emplace_back(std::move(message));
+      stats.messages += fresh.size();
+
+      {
+        std::lock_guard<std::mutex> lock{m_chats_mutex};
+        m_chats.try_emplace(record.chat_id, m_chat_capacity, m_chat_max_age_ms);
+      }
+      InsertMessages(record.chat_id, std::move(fresh));
+      stats.insert.add(Clock::now() - stage);
+
+      stage = Clock::now();
+      ParseTokens(record.chat_id);
+      stats.tokenize.add(Clock::now() - stage);
+
+      stage = Clock::now();
+      std::vector<ChatMention> mentions{};
+      {
+        std::lock_guard<std::mutex> lock{m_chats_mutex};
+        const auto                  it = m_chats.find(record.chat_id);
+        if (it != m_chats.end()) {
+          ChatBuffer::Cursor& cursor = cursors[record.chat_id];
+          std::string_view    id     = record.chat_id;
+
+          cursor = it->second.read(cursor, [this, &mentions, id](ChatBuffer::Cursor seq, const LiveMessage& message) {
+            m_mentions.scan(message.text, [&mentions, id, seq](const MentionMatch& match) {
+              mentions.push_back(ChatMention{id, seq, match});
+            });
+          });
+        }
+      }
+      stats.match.add(Clock::now() - stage);
+      stats.mentions += mentions.size();
+
+      if (!respond)
+        return;
+
+      stage = Clock::now();
+      for (std::size_t i = 0; i < mentions.size();) {
+        const ChatMention&        mention = mentions[i];
+        std::vector<MentionMatch> matches{};
+        for (; i < mentions.size() && mentions[i].message == mention.message; i++)
+          matches.push_back(mentions[i].match);
+
+        LiveMessage message{};
+        bool        found{false};
+        {
+          std::lock_guard<std::mutex> lock{m_chats_mutex};
+          const auto                  it = m_chats.find(record.chat_id);
+          found = it != m_chats.end() && it->second.at(mention.message, [&message](const LiveMessage& held) { message = held; });
         }
+
+        if (found && !respond(record.chat_id, message, matches).empty())
+          stats.replies++;
       }
-    return (!GetCurrentChat().at(0).tokens.empty());
+      stats.respond.add(Clock::now() - stage);
+    });
+
+    stats.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+
+    return stats;
   }
-  return false;
-}
 
   /**
    * GetChats
    *
-   * @returns [out] {LiveChatMap}
+   * @returns [out] {LiveChatMap} copy of every chat
    */
   LiveChatMap YouTubeDataAPI::GetChats() {
-    return m_chats;
+    LiveChatMap chats{};
+
+    for (const auto& [id, chat] : m_chats)
+      chats.emplace(id, chat.messages());
+
+    return chats;
+  }
+
+  /**
+   * SetChatMap
+   *
+   * Replaces every chat, and stops watching the ones the hub was polling.
+   * Pipeline batches hold their own copy of the messages, so a batch of an
+   * old chat still in flight is answered but writes nothing back.
+   *
+   * @param   [in]  {LiveChatMap}
+   */
+  void YouTubeDataAPI::SetChatMap(LiveChatMap chat_map) {
+    m_chat_hub.clear();
+    m_mention_cursors.clear();
+    m_token_cursors.clear();
+
+    std::lock_guard<std::mutex> lock{m_chats_mutex};
+    m_chats.clear();
+
+    for (auto& [id, messages] : chat_map)
+      m_chats.try_emplace(id, m_chat_capacity, m_chat_max_age_ms).first->second.push(std::move(messages));
   }
 
   /**
@@ -246,7 +558,42 @@ std::string to_youtube_url(const std::string& id)
    * @returns [out] {LiveMessages}
    */
   LiveMessages YouTubeDataAPI::GetCurrentChat(bool keep_messages) {
-    return m_chats.at(m_video_details.chat_id);
+    return GetChat(m_video_details.chat_id);
+  }
+
+  /**
+   * GetChat
+   *
+   * @param   [in]  {std::string}  chat_id
+   * @returns [out] {LiveMessages}
+   */
+  LiveMessages YouTubeDataAPI::GetChat(const std::string& chat_id) {
+    const auto it = m_chats.find(chat_id);
+    return (it != m_chats.end()) ? it->second.messages() : LiveMessages{};
+  }
+
+  /**
+   * TakeChat
+   *
+   * @param   [in]  {std::string}  chat_id
+   * @returns [out] {LiveMessages} the chat's messages, moved out of its buffer
+   */
+  LiveMessages YouTubeDataAPI::TakeChat(const std::string& chat_id) {
+    const auto it = m_chats.find(chat_id);
+    return (it != m_chats.end()) ? it->second.take() : LiveMessages{};
+  }
+
+  /**
+   * GetChatBuffer
+   *
+   * Reads a chat in place, without copying its messages
+   *
+   * @param   [in]  {std::string} chat_id
+   * @returns [out] {ChatBuffer*} nullptr if there is no such chat
+   */
+  const ChatBuffer* YouTubeDataAPI::GetChatBuffer(const std::string& chat_id) const {
+    const auto it = m_chats.find(chat_id);
+    return (it != m_chats.end()) ? &it->second : nullptr;
   }
 
   /**
@@ -255,7 +602,7 @@ std::string to_youtube_url(const std::string& id)
    * @returns [out] {bool}
    */
   bool YouTubeDataAPI::HasChats() {
-    return !m_chats.empty() && !GetCurrentChat().empty();
+    return !m_chats.empty() && !m_chats.at(m_video_details.chat_id).empty();
   }
 
   /**
@@ -265,9 +612,9 @@ std::string to_youtube_url(const std::string& id)
    * @param   [in]  {LiveMessages}
    * @returns [out] {bool}
    */
-  bool YouTubeDataAPI::InsertMessages(std::string id, LiveMessages&& messages) {
-    if (m_chats.find(id) != m_chats.end()) {
-      for (auto&& message : messages) m_chats.at(id).emplace_back(message);
+  bool YouTubeDataAPI::InsertMessages(const std::string& id, LiveMessages&& messages) {
+    if (auto it = m_chats.find(id); it != m_chats.end()) {
+      it->second.push(std::move(messages));
       return true;
     }
     return false;
@@ -292,34 +639,58 @@ std::string to_youtube_url(const std::string& id)
   /**
    * FindMentions
    *
+   * Messages that mention the bot, use a command or contain a watch keyword
+   *
+   * @param   [in]  {bool}         keep_messages Return the same messages again on the next call
    * @returns [out] {LiveMessages}
    */
   LiveMessages YouTubeDataAPI::FindMentions(bool keep_messages) {
-    using ChatPair = std::map<std::string, LiveMessages>;
-    const std::string bot_name = GetUsername();
+    LiveMessages       matches{};
+    const ChatMention* last{nullptr};
+
+    for (const auto& mention : ScanMentions(!keep_messages)) {
+      if (last && last->chat_id == mention.chat_id && last->message == mention.message) {
+        continue; // Several patterns in one message
+      }
 
-    LiveMessages matches{};
+      m_chats.at(std::string{mention.chat_id}).at(mention.message, [&matches](const LiveMessage& message) {
+        matches.push_back(message);
+      });
+      last = &mention;
+    }
 
-    for (const Chat& m : GetChats()) {
-      std::string            chat_name = m.first;
-      LiveMessages           messages  = m.second;
-      LiveMessages::iterator it        = messages.begin();
+    return matches;
+  }
 
-      for (; it != messages.end(); ) {
-        LiveMessage message = *it;
+  /**
+   * ScanMentions
+   *
+   * Runs every message that arrived since the previous consuming scan through
+   * the mention matcher in a single pass. Matches refer to messages by chat
+   * and sequence number instead of copying them.
+   *
+   * @param   [in]  {bool}                     consume Advance past the scanned messages
+   * @returns [out] {std::vector<ChatMention>}
+   */
+  std::vector<ChatMention> YouTubeDataAPI::ScanMentions(const bool consume) {
+    std::vector<ChatMention> mentions{};
 
-        if (message.text.find(bot_name) != std::string::npos) {
-          matches.push_back(message);
+    for (const auto& [chat_id, chat] : m_chats) {
+      ChatBuffer::Cursor& cursor = m_mention_cursors[chat_id];
+      std::string_view    id     = chat_id;
 
-          (keep_messages) ?
-            it++ :
-            it = messages.erase(it);
-        } else {
-          it++;
-        }
+      const ChatBuffer::Cursor end = chat.read(cursor, [this, &mentions, id](ChatBuffer::Cursor seq, const LiveMessage& message) {
+        m_mentions.scan(message.text, [&mentions, id, seq](const MentionMatch& match) {
+          mentions.push_back(ChatMention{id, seq, match});
+        });
+      });
+
+      if (consume) {
+        cursor = end;
       }
     }
-    return matches;
+
+    return mentions;
   }
 
   /**
@@ -347,26 +718,65 @@ std::string to_youtube_url(const std::string& id)
   /**
    * PostMessage
    *
-   * @param
-   * @returns
+   * Waits for the post. Coalescing is off, so the message goes out on its own.
+   *
+   * @param   [in]  {std::string} message
+   * @param   [in]  {std::string} chat_id (optional) defaults to the current chat
+   * @returns [out] {bool}
    */
-  bool YouTubeDataAPI::PostMessage(std::string message) {
-    using namespace constants;
+  bool YouTubeDataAPI::PostMessage(std::string message, std::string chat_id) {
+    return PostMessageAsync(std::move(message), std::move(chat_id), false).get();
+  }
 
-    if (m_video_details.chat_id.empty()) {
+  /**
+   * PostMessageAsync
+   *
+   * Queues a message for the outbox. It is posted once the chat's send
+   * interval has passed. With coalesce set, and coalescing enabled in the
+   * config, it may be joined with other replies queued meanwhile.
+   *
+   * @param   [in]  {std::string} message
+   * @param   [in]  {std::string} chat_id  (optional) defaults to the current chat
+   * @param   [in]  {bool}        coalesce (optional) may share a post with other messages
+   * @returns [out] {std::future<bool>} whether the post carrying the message succeeded
+   */
+  std::future<bool> YouTubeDataAPI::PostMessageAsync(std::string message, std::string chat_id, const bool coalesce) {
+    chat_id = (chat_id.empty()) ? m_video_details.chat_id : chat_id;
+
+    if (chat_id.empty()) {
       log("No chat to post to");
-      return false;
+      std::promise<bool> failed{};
+      failed.set_value(false);
+      return failed.get_future();
     }
 
-    log("Posting " + message);
+    return m_outbox.post(chat_id, std::move(message), coalesce);
+  }
+
+  /**
+   * send_chat_message
+   *
+   * @param   [in]  {std::string} chat_id
+   * @param   [in]  {std::string} text
+   * @returns [out] {bool} true only for a 2xx answer, false for transport failures and error statuses
+   */
+  bool YouTubeDataAPI::send_chat_message(const std::string& chat_id, const std::string& text) {
+    using namespace constants;
 
-    json payload{};
-    payload["snippet"]["liveChatId"]                        = m_video_details.chat_id;
-    payload["snippet"]["live_chat_id"]                      = m_video_details.chat_id;
-    payload["snippet"]["textMessageDetails"]["messageText"] = message;
-    payload["snippet"]["type"]                              = "textMessageEvent";
+    if (charge({youtube::LIVE_CHAT_POST_QUOTA_INDEX, QuotaPriority::reply}) != Admission::admit)
+      return false;
+
+    log("Posting " + text);
 
-    cpr::Response r = cpr::Post(
+    const json payload{
+      {"snippet", {
+        {"liveChatId",         chat_id},
+        {"type",               "textMessageEvent"},
+        {"textMessageDetails", {{"messageText", text}}}
+      }}
+    };
+
+    cpr::Response r = m_sessions.Post(
       cpr::Url{URL_VALUES.at(LIVE_CHAT_URL_INDEX)},
       cpr::Header{
         {HEADER_NAMES.at(ACCEPT_HEADER_INDEX), HEADER_VALUES.at(APP_JSON_INDEX)},
@@ -376,13 +786,19 @@ std::string to_youtube_url(const std::string& id)
       cpr::Parameters{
         {PARAM_NAMES.at(PART_INDEX),           PARAM_VALUES.at(SNIPPET_INDEX)},
         {PARAM_NAMES.at(KEY_INDEX),            m_authenticator.get_key()},
-        {PARAM_NAMES.at(LIVE_CHAT_ID_INDEX),   m_video_details.chat_id},
+        {PARAM_NAMES.at(LIVE_CHAT_ID_INDEX),   chat_id},
       },
       cpr::Body{payload.dump()}//,
       // cpr::VerifySsl{m_authenticator.verify_ssl()}
     );
 
-    return r.status_code < 400;
+    const RequestResponse response{r};
+    if (response.error) {
+      log("Error response from server:\n" + response.GetError());
+      return false;
+    }
+
+    return r.status_code >= 200 && r.status_code < 300;
   }
 
 /**
@@ -406,97 +822,34 @@ bool YouTubeDataAPI::GreetOnEntry() {
 /**
  * RecordInteraction
  *
- * @param
- * @param
+ * @param [in] {std::string_view} id          channel id of the chatter
+ * @param [in] {Interaction}      interaction
+ * @param [in] {std::string_view} value       what it was about, e.g. a person or place
  */
-void YouTubeDataAPI::RecordInteraction(std::string id, Interaction interaction, std::string value) {
-  if (m_interactions.find(id) == m_interactions.end()) {
-    std::pair<std::string, bool> interaction_pair{value, true};
-    m_interactions.insert({id, UserInteraction{.id = id}});
-    if (interaction == Interaction::greeting) {
-      m_persons.insert(interaction_pair);
-    }
-    else
-    if (interaction == Interaction::location_ask) {
-      m_locations.insert(interaction_pair);
-    }
-    else
-    if (interaction == Interaction::probing) {
-      m_orgs.insert(interaction_pair);
-    }
-  }
-
-  UserInteraction& user_interaction = m_interactions.at(id);
-
-  if (interaction == Interaction::greeting) {
-    user_interaction.greeted = true;
-  }
-  else
-  if (interaction == Interaction::promotion) {
-    user_interaction.promoted = true;
-  }
-  else
-  if (interaction == Interaction::probing) {
-    user_interaction.probed = true;
-  }
-  else
-  if (interaction == Interaction::location_ask) {
-    user_interaction.location = true;
-  }
+void YouTubeDataAPI::RecordInteraction(const std::string_view id, Interaction interaction, const std::string_view value) {
+  m_interactions.record(id, interaction, value);
 }
 
 /**
  * HasInteracted
+ *
+ * @param   [in]  {std::string_view} id
+ * @param   [in]  {Interaction}      interaction
+ * @returns [out] {bool}
  */
-bool YouTubeDataAPI::HasInteracted(std::string id, Interaction interaction) {
-  if (m_interactions.find(id) == m_interactions.end())
-    return false;
-
-
-  UserInteraction& user_interaction = m_interactions.at(id);
-
-  bool has_interacted{false};
-
-  if (interaction == Interaction::greeting) {
-    has_interacted = user_interaction.greeted;
-  }
-  else
-  if (interaction == Interaction::promotion) {
-    has_interacted = user_interaction.promoted;
-  }
-  else
-  if (interaction == Interaction::probing) {
-    has_interacted = user_interaction.probed;
-  }
-  else
-  if (interaction == Interaction::location_ask) {
-    has_interacted = user_interaction.location;
-  }
-
-  return has_interacted;
+bool YouTubeDataAPI::HasInteracted(const std::string_view id, Interaction interaction) {
+  return m_interactions.has_interacted(id, interaction);
 }
 
 /**
+ * HasDiscussed
  *
+ * @param   [in]  {std::string_view} value
+ * @param   [in]  {Interaction}      type
+ * @returns [out] {bool}
  */
-bool YouTubeDataAPI::HasDiscussed(std::string value, Interaction type) {
-  std::map<std::string, bool>::iterator it{};
-  if (type == Interaction::greeting) {
-    it = m_persons.find(value);
-  }
-  else
-  if (type == Interaction::promotion) {
-    // TODO: ?
-  }
-  else
-  if (type == Interaction::probing) {
-    it = m_orgs.find(value);
-  }
-  else
-  if (type == Interaction::location_ask) {
-    it = m_locations.find(value);
-  }
-  return (it->second == true);
+bool YouTubeDataAPI::HasDiscussed(const std::string_view value, Interaction type) {
+  return m_interactions.has_discussed(value, type);
 }
 
 } // namespace ktube
@@ -52,8 +52,9 @@ static std::string get_config(const std::string& name, const std::string& defaul
 }
 
 
-Authenticator::Authenticator()
-: m_authenticated{false},
+Authenticator::Authenticator(SessionPool& sessions)
+: m_sessions{sessions},
+  m_authenticated{false},
   m_tokens_json{nullptr},
   m_verify_ssl{true}
 {
@@ -116,17 +117,17 @@ bool Authenticator::refresh_access_token()
 
   try
   {
-    response = cpr::Post(
+    response = m_sessions.Post(
       cpr::Url{URL_VALUES.at(GOOGLE_AUTH_URL_INDEX)},
       cpr::Header{
         {HEADER_NAMES.at(CONTENT_TYPE_INDEX), HEADER_VALUES.at(FORM_URL_ENC_INDEX)}
       },
-      cpr::VerifySsl(m_verify_ssl),
       cpr::Body{
         PARAM_NAMES.at(CLIENT_ID_INDEX)          + "=" + m_auth.client_id + "&" +
         PARAM_NAMES.at(CLIENT_SECRET_INDEX)      + "=" + m_auth.client_secret + "&" +
         PARAM_NAMES.at(REFRESH_TOKEN_NAME_INDEX) + "=" + m_auth.refresh_token + "&" +
-        PARAM_NAMES.at(GRANT_TYPE_INDEX)         + "=" + PARAM_VALUES.at(REFRESH_TOKEN_VALUE_INDEX)});
+        PARAM_NAMES.at(GRANT_TYPE_INDEX)         + "=" + PARAM_VALUES.at(REFRESH_TOKEN_VALUE_INDEX)},
+      cpr::VerifySsl(m_verify_ssl));
   }
   catch (const std::exception& e)
   {
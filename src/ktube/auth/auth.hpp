@@ -2,6 +2,7 @@
 
 #include "ktube/common/youtube_util.hpp"
 #include "ktube/common/request.hpp"
+#include "ktube/common/session.hpp"
 
 namespace ktube {
 struct AuthData {
@@ -22,7 +23,7 @@ class Authenticator {
 
 public:
 
-  Authenticator();
+  explicit Authenticator(SessionPool& sessions);
   bool FetchToken(const bool fetch_fresh_token = false);
   bool refresh_access_token();
   bool is_authenticated();
@@ -33,6 +34,7 @@ public:
 private:
   using json = nlohmann::json;
 
+  SessionPool& m_sessions;
   AuthData     m_auth;
   bool         m_authenticated;
   std::string  m_username;
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "constants.hpp"
+
+namespace ktube {
+using IDList = std::vector<std::string>;
+
+/**
+ * SplitIDs
+ *
+ * Helper function to read a comma separated id string into a list of ids
+ *
+ * @param   [in]  {std::string}
+ * @returns [out] {IDList}
+ */
+inline IDList SplitIDs(const std::string& id_string) {
+  IDList      ids{};
+  std::size_t start{0};
+
+  while (start <= id_string.size())
+  {
+    std::size_t end = id_string.find(',', start);
+    if (end == std::string::npos)
+      end = id_string.size();
+
+    if (end > start)
+      ids.emplace_back(id_string.substr(start, end - start));
+
+    start = end + 1;
+  }
+
+  return ids;
+}
+
+/**
+ * UniqueIDs
+ *
+ * Removes empty and duplicate ids, keeping the first occurrence of each
+ *
+ * @param   [in]  {IDList}
+ * @returns [out] {IDList}
+ */
+inline IDList UniqueIDs(const IDList& ids) {
+  IDList                          unique{};
+  std::unordered_set<std::string> seen{};
+  unique.reserve(ids.size());
+  seen  .reserve(ids.size());
+
+  for (const auto& id : ids)
+    if (!id.empty() && seen.insert(id).second)
+      unique.emplace_back(id);
+
+  return unique;
+}
+
+/**
+ * ChunkIDs
+ *
+ * Splits ids into comma separated strings of at most chunk_size ids each,
+ * which is the form the list endpoints take in their id parameter
+ *
+ * @param   [in]  {IDList}
+ * @param   [in]  {std::size_t}
+ * @returns [out] {std::vector<std::string>}
+ */
+inline std::vector<std::string> ChunkIDs(const IDList&     ids,
+                                         const std::size_t chunk_size = constants::youtube::MAX_IDS_PER_REQUEST) {
+  std::vector<std::string> chunks{};
+  const std::size_t        size = chunk_size ? chunk_size : 1;
+  chunks.reserve(ids.size() / size + 1);
+
+  for (std::size_t i = 0; i < ids.size(); i++)
+  {
+    if (i % size == 0)
+      chunks.emplace_back(ids[i]);
+    else
+      chunks.back() += ',' + ids[i];
+  }
+
+  return chunks;
+}
+
+} // namespace ktube
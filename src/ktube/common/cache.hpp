@@ -0,0 +1,114 @@
+#pragma once
+
+#include <any>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace ktube {
+/**
+ * ResponseCache
+ *
+ * Remembers the etag and decoded result of list responses, keyed by the
+ * normalized request URL. Callers send the etag back as If-None-Match and,
+ * when the server answers 304 Not Modified, take the decoded value from here
+ * without downloading or parsing the payload again.
+ *
+ * Entries are evicted oldest first once capacity is reached.
+ */
+class ResponseCache {
+public:
+static constexpr std::size_t DEFAULT_CAPACITY{512};
+
+explicit ResponseCache(const std::size_t capacity = DEFAULT_CAPACITY)
+: m_capacity(capacity ? capacity : 1) {}
+
+/**
+ * etag
+ *
+ * @param   [in]  {std::string} key
+ * @returns [out] {std::string} empty when nothing is cached for key
+ */
+std::string etag(const std::string& key) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  const auto it = m_entries.find(key);
+  return (it != m_entries.end()) ? it->second.etag : "";
+}
+
+/**
+ * get
+ *
+ * @param   [in]  {std::string}      key
+ * @returns [out] {std::optional<T>} the decoded value stored for key
+ */
+template <typename T>
+std::optional<T> get(const std::string& key) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  const auto it = m_entries.find(key);
+  if (it != m_entries.end())
+    if (const T* value = std::any_cast<T>(&it->second.value))
+      return *value;
+  return std::nullopt;
+}
+
+/**
+ * put
+ *
+ * @param [in] {std::string} key
+ * @param [in] {std::string} etag  Nothing is stored without an etag
+ * @param [in] {T}           value
+ */
+template <typename T>
+void put(const std::string& key, const std::string& etag, T value)
+{
+  if (etag.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  auto it = m_entries.find(key);
+
+  if (it == m_entries.end())
+  {
+    if (m_entries.size() >= m_capacity)
+    {
+      m_entries.erase(m_order.front());
+      m_order.pop_front();
+    }
+    m_order.emplace_back(key);
+    it = m_entries.emplace(key, Entry{}).first;
+  }
+
+  it->second.etag  = etag;
+  it->second.value = std::move(value);
+}
+
+void erase(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (m_entries.erase(key))
+    m_order.remove(key);
+}
+
+std::size_t size() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_entries.size();
+}
+
+private:
+struct Entry {
+std::string etag;
+std::any    value;
+};
+
+std::unordered_map<std::string, Entry> m_entries;
+std::list<std::string>                 m_order;
+std::size_t                            m_capacity;
+mutable std::mutex                     m_mutex;
+};
+
+} // namespace ktube
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ktube {
+/**
+ * ChatBuffer
+ *
+ * Fixed-capacity ring of live chat messages. Once full, each new message
+ * overwrites the oldest one, and messages published more than max_age_ms
+ * before the newest are dropped as well (0 keeps them until overwritten).
+ * Slots are allocated once up front, so a long stream costs no more memory
+ * than a short one and adding a message never moves the others.
+ *
+ * Every message gets a sequence number. A cursor is the sequence number to
+ * read from, so a consumer can visit only what arrived since its last read
+ * without copying anything:
+ *
+ *   cursor = buffer.read(cursor, [](const LiveMessage& message) { ... });
+ */
+class ChatBuffer {
+public:
+using Cursor = uint64_t;
+
+static constexpr std::size_t DEFAULT_CAPACITY{2048};
+static constexpr int64_t     DEFAULT_MAX_AGE_MS{0};
+
+explicit ChatBuffer(const std::size_t capacity   = DEFAULT_CAPACITY,
+                    const int64_t     max_age_ms = DEFAULT_MAX_AGE_MS)
+: m_slots(capacity ? capacity : 1),
+  m_max_age_ms(max_age_ms),
+  m_head(0),
+  m_tail(0) {}
+
+ChatBuffer(const ChatBuffer&)            = delete;
+ChatBuffer& operator=(const ChatBuffer&) = delete;
+
+/**
+ * push
+ *
+ * @param   [in]  {LiveMessage} message
+ * @returns [out] {Cursor}      sequence number of the message
+ */
+Cursor push(LiveMessage message)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return append(std::move(message));
+}
+
+/**
+ * push
+ *
+ * @param   [in]  {LiveMessages} messages
+ * @returns [out] {Cursor}       sequence number of the first message
+ */
+Cursor push(LiveMessages&& messages)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  const Cursor                first = m_tail;
+  for (auto& message : messages)
+    append(std::move(message));
+  return first;
+}
+
+/**
+ * read
+ *
+ * Visits every message still held from `since` onwards, oldest first
+ *
+ * @param   [in]  {Cursor} since
+ * @param   [in]  {F}      fn    void(const LiveMessage&) or void(Cursor, const LiveMessage&)
+ * @returns [out] {Cursor}       cursor for the next read
+ */
+template <typename F>
+Cursor read(const Cursor since, F&& fn) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  for (Cursor seq = std::max(since, m_head); seq < m_tail; seq++)
+    if constexpr (std::is_invocable_v<F, Cursor, const LiveMessage&>)
+      fn(seq, m_slots[seq % m_slots.size()]);
+    else
+      fn(m_slots[seq % m_slots.size()]);
+  return m_tail;
+}
+
+/**
+ * at
+ *
+ * @param   [in]  {Cursor} seq
+ * @param   [in]  {F}      fn  void(const LiveMessage&), or void(LiveMessage&) to modify it
+ * @returns [out] {bool}   false if the message is no longer held
+ */
+template <typename F>
+bool at(const Cursor seq, F&& fn) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (seq < m_head || seq >= m_tail)
+    return false;
+  fn(m_slots[seq % m_slots.size()]);
+  return true;
+}
+
+template <typename F>
+bool at(const Cursor seq, F&& fn)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (seq < m_head || seq >= m_tail)
+    return false;
+  fn(m_slots[seq % m_slots.size()]);
+  return true;
+}
+
+/**
+ * update
+ *
+ * Like read, but the messages may be modified in place
+ */
+template <typename F>
+Cursor update(const Cursor since, F&& fn)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  for (Cursor seq = std::max(since, m_head); seq < m_tail; seq++)
+    fn(m_slots[seq % m_slots.size()]);
+  return m_tail;
+}
+
+/**
+ * messages
+ *
+ * @param   [in]  {Cursor}       since
+ * @returns [out] {LiveMessages} copy of the messages from since onwards
+ */
+LiveMessages messages(const Cursor since = 0) const
+{
+  LiveMessages copy{};
+  copy.reserve(size());
+  read(since, [&copy](const LiveMessage& message) { copy.emplace_back(message); });
+  return copy;
+}
+
+/**
+ * take
+ *
+ * @returns [out] {LiveMessages} every message, moved out. The buffer is left empty.
+ */
+LiveMessages take()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  LiveMessages                messages{};
+  messages.reserve(m_tail - m_head);
+
+  for (Cursor seq = m_head; seq < m_tail; seq++)
+    messages.emplace_back(std::move(m_slots[seq % m_slots.size()]));
+
+  m_head = m_tail;
+  return messages;
+}
+
+/**
+ * set_retention
+ *
+ * Keeps the newest messages that fit the new limits
+ */
+void set_retention(const std::size_t capacity, const int64_t max_age_ms)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  std::vector<LiveMessage>    slots(capacity ? capacity : 1);
+  const Cursor                head = std::max(m_head, m_tail - std::min<Cursor>(m_tail, slots.size()));
+
+  for (Cursor seq = head; seq < m_tail; seq++)
+    slots[seq % slots.size()] = std::move(m_slots[seq % m_slots.size()]);
+
+  m_slots      = std::move(slots);
+  m_max_age_ms = max_age_ms;
+  m_head       = head;
+  expire();
+}
+
+void clear()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_head = m_tail;
+}
+
+Cursor      begin()    const { std::lock_guard<std::mutex> lock{m_mutex}; return m_head;          }
+Cursor      end()      const { std::lock_guard<std::mutex> lock{m_mutex}; return m_tail;          }
+std::size_t size()     const { std::lock_guard<std::mutex> lock{m_mutex}; return m_tail - m_head; }
+bool        empty()    const { return size() == 0; }
+std::size_t capacity() const { std::lock_guard<std::mutex> lock{m_mutex}; return m_slots.size(); }
+
+private:
+Cursor append(LiveMessage&& message)
+{
+  if (m_tail - m_head == m_slots.size())
+    m_head++;
+
+  m_slots[m_tail % m_slots.size()] = std::move(message);
+  m_tail++;
+  expire();
+
+  return m_tail - 1;
+}
+
+void expire()
+{
+  if (!m_max_age_ms || m_head == m_tail)
+    return;
+
+  const int64_t newest = m_slots[(m_tail - 1) % m_slots.size()].published;
+
+  while (m_head < m_tail)
+  {
+    const int64_t published = m_slots[m_head % m_slots.size()].published;
+    if (!published || newest - published <= m_max_age_ms)
+      break;
+    m_head++;
+  }
+}
+
+std::vector<LiveMessage> m_slots;
+int64_t                  m_max_age_ms;
+Cursor                   m_head;
+Cursor                   m_tail;
+mutable std::mutex       m_mutex;
+};
+
+using ChatStore = std::map<std::string, ChatBuffer>;
+
+} // namespace ktube
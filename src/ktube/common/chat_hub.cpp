@@ -0,0 +1,246 @@
+#include "chat_hub.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "constants.hpp"
+
+namespace ktube {
+ChatHub::ChatHub(Factory create, Executor& executor)
+: m_create(std::move(create)),
+  m_executor(executor),
+  m_running(false),
+  m_generation(0),
+  m_alive(std::make_shared<bool>(true)) {}
+//-----------------------------------------------------------------------
+/**
+ * ~ChatHub
+ *
+ * Destroyed on its own thread, the loop cannot be joined; it is detached and
+ * ends without touching the hub again.
+ */
+ChatHub::~ChatHub()
+{
+  stop();
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_condition.wait(lock, [this] { return m_scheduled.empty(); });
+  }
+
+  if (m_thread.joinable())
+  {
+    *m_alive = false;
+    m_thread.detach();
+  }
+}
+//-----------------------------------------------------------------------
+bool ChatHub::add(const std::string& chat_id, ChatPoller::Subscriber subscriber)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (chat_id.empty() || m_sessions.find(chat_id) != m_sessions.end())
+      return false;
+
+    std::shared_ptr<ChatPoller> poller = m_create(chat_id);
+    if (subscriber)
+      poller->subscribe(std::move(subscriber));
+    m_sessions.emplace(chat_id, std::move(poller));
+  }
+  m_condition.notify_all();
+
+  return true;
+}
+//-----------------------------------------------------------------------
+bool ChatHub::remove(const std::string& chat_id)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_sessions.erase(chat_id) > 0;
+}
+//-----------------------------------------------------------------------
+void ChatHub::clear()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_sessions.clear();
+}
+//-----------------------------------------------------------------------
+std::size_t ChatHub::poll()
+{
+  std::vector<std::shared_ptr<ChatPoller>> due{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (const auto& [chat_id, poller] : m_sessions)
+      if (poller->due())
+        due.push_back(poller);
+  }
+
+  std::size_t delivered{0};
+  for (const std::size_t count : m_executor.map(due, [](std::shared_ptr<ChatPoller>& poller) { return poller->poll(); }))
+    delivered += count;
+
+  return delivered;
+}
+//-----------------------------------------------------------------------
+std::size_t ChatHub::poll(const std::string& chat_id)
+{
+  const std::shared_ptr<ChatPoller> poller = session(chat_id);
+  return (poller) ? poller->poll() : 0;
+}
+//-----------------------------------------------------------------------
+/**
+ * dispatch
+ *
+ * Schedules every due session the loop has not scheduled yet, each as its
+ * own executor task, and returns without waiting for them. A finished task
+ * wakes the loop, under the lock so a waiting destructor cannot run first.
+ */
+void ChatHub::dispatch()
+{
+  std::vector<std::shared_ptr<ChatPoller>> due{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (const auto& [chat_id, poller] : m_sessions)
+      if (m_scheduled.find(poller.get()) == m_scheduled.end() && poller->due())
+      {
+        m_scheduled.insert(poller.get());
+        due.push_back(poller);
+      }
+  }
+
+  for (auto& poller : due)
+    m_executor.submit([this, poller]
+    {
+      poller->poll();
+
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_scheduled.erase(poller.get());
+      m_condition.notify_all();
+    });
+}
+//-----------------------------------------------------------------------
+/**
+ * start
+ *
+ * Works like ChatPoller::start: a stopped loop is joined first, a restart
+ * from the hub's own thread carries on, and a new loop ends any older one.
+ */
+void ChatHub::start()
+{
+  std::thread stopped{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_running)
+      return;
+
+    if (m_thread.joinable() && m_thread.get_id() == std::this_thread::get_id())
+    {
+      m_running = true;
+      return;
+    }
+
+    stopped = std::exchange(m_thread, std::thread{});
+  }
+
+  if (stopped.joinable())
+    stopped.join();
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (m_running || m_thread.joinable())
+    return;
+
+  m_running = true;
+  m_thread  = std::thread{[this, generation = ++m_generation, alive = m_alive] { run(generation, alive); }};
+}
+//-----------------------------------------------------------------------
+/**
+ * stop
+ *
+ * The thread is taken out under the lock and joined outside it. Called on
+ * the hub's own thread, this only asks the loop to end after the current
+ * poll; the thread is joined on the next start() or on destruction.
+ */
+void ChatHub::stop()
+{
+  std::thread thread{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_running = false;
+    if (m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id())
+      thread = std::exchange(m_thread, std::thread{});
+  }
+  m_condition.notify_all();
+
+  if (thread.joinable())
+    thread.join();
+}
+//-----------------------------------------------------------------------
+void ChatHub::run(const uint64_t generation, const std::shared_ptr<bool> alive)
+{
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      Clock::time_point            wake = Clock::now() + std::chrono::milliseconds{constants::youtube::DEFAULT_CHAT_POLL_INTERVAL_MS};
+      for (const auto& [chat_id, poller] : m_sessions)
+        if (m_scheduled.find(poller.get()) == m_scheduled.end())
+          wake = std::min(wake, poller->next_poll());
+
+      const std::size_t sessions  = m_sessions.size();
+      const std::size_t scheduled = m_scheduled.size();
+      const auto        stopped   = [this, generation] { return !m_running || m_generation != generation; };
+      m_condition.wait_until(lock, wake, [this, sessions, scheduled, &stopped] {
+        return stopped() || m_sessions.size() > sessions || m_scheduled.size() < scheduled;
+      });
+      if (stopped())
+        return;
+    }
+    dispatch();
+    if (!*alive)
+      return;
+  }
+}
+//-----------------------------------------------------------------------
+bool ChatHub::running() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_running;
+}
+//-----------------------------------------------------------------------
+bool ChatHub::contains(const std::string& chat_id) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_sessions.find(chat_id) != m_sessions.end();
+}
+//-----------------------------------------------------------------------
+std::shared_ptr<ChatPoller> ChatHub::session(const std::string& chat_id) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  const auto it = m_sessions.find(chat_id);
+  return (it != m_sessions.end()) ? it->second : nullptr;
+}
+//-----------------------------------------------------------------------
+std::vector<std::string> ChatHub::chats() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  std::vector<std::string>    ids{};
+  ids.reserve(m_sessions.size());
+  for (const auto& [chat_id, poller] : m_sessions)
+    ids.push_back(chat_id);
+  return ids;
+}
+//-----------------------------------------------------------------------
+std::size_t ChatHub::size() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_sessions.size();
+}
+//-----------------------------------------------------------------------
+ChatHub::Clock::time_point ChatHub::next_poll() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  Clock::time_point           next = Clock::time_point::max();
+  for (const auto& [chat_id, poller] : m_sessions)
+    next = std::min(next, poller->next_poll());
+  return next;
+}
+
+} // namespace ktube
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chat_poller.hpp"
+#include "executor.hpp"
+
+namespace ktube {
+/**
+ * ChatHub
+ *
+ * Watches many live chats from one process. Every chat is a session with its
+ * own ChatPoller, and so its own page token and polling interval. The
+ * sessions share whatever the factory closes over. For YouTubeDataAPI that
+ * is the session pool, the retrier and the quota budget.
+ *
+ * One event loop thread sleeps until the earliest session is due, then
+ * hands every due session to the executor as a task of its own and goes back
+ * to sleep. A slow stream only delays its own next poll, and a session is
+ * scheduled again once its poll has finished. Thirty streams cost one thread
+ * plus the executor, not thirty of each.
+ *
+ * No hub-wide lock is held while a poll runs, so remove() and clear() may be
+ * called from a subscriber. A poll of a removed chat that was already in
+ * flight still delivers once; subscribers should look up whatever they write
+ * to by chat id rather than hold on to it.
+ *
+ * The hub must not be destroyed from a subscriber, as its destructor waits
+ * for the polls it scheduled.
+ */
+class ChatHub {
+public:
+using Clock   = ChatPoller::Clock;
+using Factory = std::function<std::unique_ptr<ChatPoller>(const std::string& chat_id)>;
+
+ChatHub(Factory create, Executor& executor);
+~ChatHub();
+
+ChatHub(const ChatHub&)            = delete;
+ChatHub& operator=(const ChatHub&) = delete;
+
+/**
+ * add
+ *
+ * @param   [in]  {std::string}            chat_id
+ * @param   [in]  {ChatPoller::Subscriber} subscriber receives the new messages of this chat
+ * @returns [out] {bool} false if the chat is already watched
+ */
+bool                      add(const std::string& chat_id, ChatPoller::Subscriber subscriber);
+bool                      remove(const std::string& chat_id);
+void                      clear();
+
+/**
+ * poll
+ *
+ * Polls every session that is due, concurrently
+ *
+ * @returns [out] {std::size_t} number of new messages delivered across all chats
+ */
+std::size_t               poll();
+
+/**
+ * poll
+ *
+ * Polls one session now, whether or not it is due
+ *
+ * @param   [in]  {std::string} chat_id
+ * @returns [out] {std::size_t} number of new messages delivered
+ */
+std::size_t               poll(const std::string& chat_id);
+void                      start();
+void                      stop();
+bool                      running()  const;
+bool                      contains(const std::string& chat_id) const;
+std::shared_ptr<ChatPoller> session(const std::string& chat_id) const;
+std::vector<std::string>  chats()    const;
+std::size_t               size()     const;
+Clock::time_point         next_poll() const;
+
+private:
+void run(const uint64_t generation, const std::shared_ptr<bool> alive);
+void dispatch();
+
+Factory                                             m_create;
+Executor&                                           m_executor;
+std::map<std::string, std::shared_ptr<ChatPoller>> m_sessions;
+std::thread                                         m_thread;
+bool                                                m_running;
+uint64_t                                            m_generation;
+std::shared_ptr<bool>                               m_alive; // false once destroyed on the hub's thread
+std::set<const ChatPoller*>                         m_scheduled; // sessions handed to the executor by the loop
+mutable std::mutex                                  m_mutex;
+std::condition_variable                             m_condition;
+};
+
+} // namespace ktube
@@ -0,0 +1,162 @@
+#include "chat_pipeline.hpp"
+
+#include <utility>
+
+namespace ktube {
+/**
+ * Idle
+ *
+ * Backs off while a stage has nothing to do: yield first, so a busy pipeline
+ * reacts within a yield, then block until ready() holds.
+ */
+template <typename Wakeup, typename F>
+static void Idle(uint32_t& spins, Wakeup& wakeup, F&& ready)
+{
+  if (spins++ < 64)
+    std::this_thread::yield();
+  else
+    wakeup.wait(std::forward<F>(ready));
+}
+//-----------------------------------------------------------------------
+ChatPipeline::ChatPipeline(Processor         process,
+                           Sender            send,
+                           const std::size_t ingest_capacity,
+                           const std::size_t reply_capacity)
+: m_process(std::move(process)),
+  m_send(std::move(send)),
+  m_ingest(ingest_capacity),
+  m_replies(reply_capacity),
+  m_running(false),
+  m_reply_stalls(0),
+  m_batches(0),
+  m_sent(0),
+  m_failures(0) {}
+//-----------------------------------------------------------------------
+ChatPipeline::~ChatPipeline()
+{
+  stop();
+}
+//-----------------------------------------------------------------------
+bool ChatPipeline::ingest(ChatBatch batch)
+{
+  if (!m_ingest.try_push(std::move(batch)))
+    return false;
+
+  m_batch_ready.notify();
+  return true;
+}
+//-----------------------------------------------------------------------
+void ChatPipeline::start()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (m_running)
+    return;
+
+  m_running   = true;
+  m_processor = std::thread{[this] { process(); }};
+  m_sender    = std::thread{[this] { send();    }};
+}
+//-----------------------------------------------------------------------
+void ChatPipeline::stop()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_running = false;
+  wake_all();
+
+  if (m_processor.joinable())
+    m_processor.join();
+  if (m_sender.joinable())
+    m_sender.join();
+
+  ChatBatch batch{};
+  ChatReply reply{};
+  while (m_ingest.try_pop(batch)) {}
+  while (m_replies.try_pop(reply))
+    m_failures++;
+}
+//-----------------------------------------------------------------------
+void ChatPipeline::wake_all()
+{
+  m_batch_ready.notify();
+  m_reply_ready.notify();
+  m_reply_room.notify();
+}
+//-----------------------------------------------------------------------
+bool ChatPipeline::running() const
+{
+  return m_running;
+}
+//-----------------------------------------------------------------------
+PipelineStats ChatPipeline::stats() const
+{
+  return PipelineStats{
+    .ingest_depth  = m_ingest.size(),
+    .reply_depth   = m_replies.size(),
+    .ingest_stalls = m_ingest.stalls(),
+    .reply_stalls  = m_reply_stalls,
+    .batches       = m_batches,
+    .replies       = m_sent,
+    .failures      = m_failures
+  };
+}
+//-----------------------------------------------------------------------
+void ChatPipeline::process()
+{
+  ChatBatch              batch{};
+  std::vector<ChatReply> replies{};
+  uint32_t               spins{0};
+
+  while (m_running)
+  {
+    if (!m_ingest.try_pop(batch))
+    {
+      Idle(spins, m_batch_ready, [this] { return !m_running || !m_ingest.empty(); });
+      continue;
+    }
+    spins = 0;
+
+    replies.clear();
+    m_process(batch, replies);
+    m_batches++;
+
+    for (auto& reply : replies)
+    {
+      if (m_replies.try_push(std::move(reply)))
+      {
+        m_reply_ready.notify();
+        continue;
+      }
+
+      m_reply_stalls++;
+      bool queued{false};
+      for (uint32_t wait{0}; m_running && !(queued = m_replies.try_push(std::move(reply)));)
+        Idle(wait, m_reply_room, [this] { return !m_running || m_replies.size() < m_replies.capacity(); });
+
+      if (queued)
+        m_reply_ready.notify();
+      else // stopped while the sender was behind
+        m_failures++;
+    }
+  }
+}
+//-----------------------------------------------------------------------
+void ChatPipeline::send()
+{
+  ChatReply reply{};
+  uint32_t  spins{0};
+
+  while (m_running)
+  {
+    if (!m_replies.try_pop(reply))
+    {
+      Idle(spins, m_reply_ready, [this] { return !m_running || !m_replies.empty(); });
+      continue;
+    }
+    spins = 0;
+    m_reply_room.notify();
+
+    m_send(reply, [this](const bool sent) { (sent) ? m_sent++ : m_failures++; });
+  }
+}
+
+} // namespace ktube
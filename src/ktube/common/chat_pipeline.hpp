@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "chat_buffer.hpp"
+#include "queue.hpp"
+
+namespace ktube {
+/**
+ * ChatBatch
+ *
+ * The messages one poll delivered, copied so a batch never refers into a
+ * chat buffer that may be gone by the time it is processed. begin is the
+ * sequence number the first of them was given in the chat's ChatBuffer.
+ */
+struct ChatBatch {
+std::string        chat_id;
+ChatBuffer::Cursor begin{0};
+LiveMessages       messages;
+};
+
+struct ChatReply {
+std::string chat_id;
+std::string text;
+};
+
+struct PipelineStats {
+std::size_t ingest_depth{0};
+std::size_t reply_depth{0};
+uint64_t    ingest_stalls{0}; // batches dropped because processing was behind
+uint64_t    reply_stalls{0};  // waits because sending was behind
+uint64_t    batches{0};
+uint64_t    replies{0};       // replies the sender reported delivered
+uint64_t    failures{0};      // replies the sender could not deliver, or still queued at stop()
+};
+
+/**
+ * ChatPipeline
+ *
+ * Splits the chat path into stages joined by bounded lock-free queues:
+ *
+ *   pollers --ingest (MPSC)--> processor --replies (SPSC)--> sender
+ *
+ * Pollers hand over a batch and return at once. If the processor is behind
+ * and the ingest queue is full, the batch is dropped and counted. The
+ * messages themselves are already in their ChatBuffer. If the sender is
+ * behind, only the processor waits. A slow post therefore never delays the
+ * next poll.
+ *
+ * A stage with nothing to do yields briefly, then sleeps until the stage
+ * before it hands over work (or the one after frees room), so an idle
+ * pipeline does not wake up at all.
+ *
+ * The sender reports each reply's outcome through its Done callback, which
+ * may be called later from another thread, such as once a ChatOutbox post
+ * completes. The owner must keep the pipeline alive until every reply handed
+ * to the sender has been reported.
+ *
+ * stop() empties both queues. Batches still waiting are discarded, and
+ * replies that were never sent are counted as failures.
+ */
+class ChatPipeline {
+public:
+using Processor = std::function<void(ChatBatch& batch, std::vector<ChatReply>& replies)>;
+using Done      = std::function<void(bool sent)>;
+using Sender    = std::function<void(const ChatReply& reply, Done done)>;
+
+static constexpr std::size_t DEFAULT_INGEST_CAPACITY{1024};
+static constexpr std::size_t DEFAULT_REPLY_CAPACITY{256};
+
+ChatPipeline(Processor         process,
+             Sender            send,
+             const std::size_t ingest_capacity = DEFAULT_INGEST_CAPACITY,
+             const std::size_t reply_capacity  = DEFAULT_REPLY_CAPACITY);
+~ChatPipeline();
+
+ChatPipeline(const ChatPipeline&)            = delete;
+ChatPipeline& operator=(const ChatPipeline&) = delete;
+
+/**
+ * ingest
+ *
+ * Never blocks
+ *
+ * @param   [in]  {ChatBatch} batch
+ * @returns [out] {bool} false if the batch was dropped
+ */
+bool          ingest(ChatBatch batch);
+void          start();
+void          stop();
+bool          running() const;
+PipelineStats stats()   const;
+
+private:
+/**
+ * Wakeup
+ *
+ * Blocks one idle stage until another has work for it. notify() costs an
+ * atomic load unless the stage is actually asleep.
+ */
+struct Wakeup {
+std::mutex              mutex;
+std::condition_variable condition;
+std::atomic<bool>       waiting{false};
+
+void notify()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!waiting.load(std::memory_order_relaxed))
+    return;
+
+  std::lock_guard<std::mutex> lock{mutex};
+  condition.notify_all();
+}
+
+template <typename F>
+void wait(F&& ready)
+{
+  std::unique_lock<std::mutex> lock{mutex};
+  waiting.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  condition.wait(lock, std::forward<F>(ready));
+  waiting.store(false, std::memory_order_relaxed);
+}
+};
+
+void process();
+void send();
+void wake_all();
+
+Processor                 m_process;
+Sender                    m_send;
+BoundedQueue<ChatBatch>   m_ingest;
+BoundedQueue<ChatReply>   m_replies;
+std::atomic<bool>         m_running;
+std::atomic<uint64_t>     m_reply_stalls;
+std::atomic<uint64_t>     m_batches;
+std::atomic<uint64_t>     m_sent;
+std::atomic<uint64_t>     m_failures;
+Wakeup                    m_batch_ready;  // ingest went non-empty
+Wakeup                    m_reply_ready;  // replies went non-empty
+Wakeup                    m_reply_room;   // replies has room again
+std::thread               m_processor;
+std::thread               m_sender;
+std::mutex                m_mutex;
+};
+
+} // namespace ktube
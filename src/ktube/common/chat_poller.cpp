@@ -0,0 +1,190 @@
+#include "chat_poller.hpp"
+
+#include <utility>
+
+#include "constants.hpp"
+
+namespace ktube {
+ChatPoller::ChatPoller(Fetcher fetch)
+: m_fetch(std::move(fetch)),
+  m_interval(constants::youtube::DEFAULT_CHAT_POLL_INTERVAL_MS),
+  m_next_poll(Clock::now()),
+  m_running(false),
+  m_polling(false),
+  m_generation(0),
+  m_alive(std::make_shared<bool>(true)) {}
+//-----------------------------------------------------------------------
+/**
+ * ~ChatPoller
+ *
+ * A subscriber that drops the last reference destroys the poller on its own
+ * thread, which cannot join itself. The thread is detached instead, and the
+ * poll and loop it returns to see the poller is gone and touch nothing more.
+ */
+ChatPoller::~ChatPoller()
+{
+  stop();
+
+  if (m_thread.joinable())
+  {
+    *m_alive = false;
+    m_thread.detach();
+  }
+}
+//-----------------------------------------------------------------------
+std::size_t ChatPoller::poll()
+{
+  struct InFlight { // cleared once delivery is done, even if fetch or a subscriber throws
+  ChatPoller&                 poller;
+  const std::shared_ptr<bool> alive;
+  ~InFlight() { if (*alive) { std::lock_guard<std::mutex> lock{poller.m_mutex}; poller.m_polling = false; } }
+  };
+
+  std::vector<Subscriber> subscribers{};
+  std::string             page_token{};
+  LiveMessages            fresh{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_polling)
+      return 0;
+    m_polling  = true;
+    page_token = m_page_token;
+  }
+
+  const InFlight in_flight{*this, m_alive};
+  ChatPoll       result = m_fetch(page_token);
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (!result.page.next_page_token.empty())
+      m_page_token = std::move(result.page.next_page_token);
+    if (result.interval.count() > 0)
+      m_interval = result.interval;
+    m_next_poll  = Clock::now() + m_interval;
+    subscribers  = m_subscribers;
+
+    fresh.reserve(result.page.items.size());
+    for (auto& message : result.page.items)
+      if (m_seen.insert(message))
+        fresh.emplace_back(std::move(message));
+  }
+
+  if (!fresh.empty())
+    for (const auto& subscriber : subscribers)
+      subscriber(fresh);
+
+  return fresh.size();
+}
+//-----------------------------------------------------------------------
+void ChatPoller::subscribe(Subscriber subscriber)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_subscribers.emplace_back(std::move(subscriber));
+}
+//-----------------------------------------------------------------------
+/**
+ * start
+ *
+ * A loop that was stopped but not yet joined is joined first. Restarted from
+ * a subscriber, the loop is still running and simply carries on. Every new
+ * loop gets a new generation, so an older one still finishing its poll ends
+ * instead of running alongside.
+ */
+void ChatPoller::start()
+{
+  std::thread stopped{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_running)
+      return;
+
+    if (m_thread.joinable() && m_thread.get_id() == std::this_thread::get_id())
+    {
+      m_running = true;
+      return;
+    }
+
+    stopped = std::exchange(m_thread, std::thread{});
+  }
+
+  if (stopped.joinable())
+    stopped.join();
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (m_running || m_thread.joinable())
+    return;
+
+  m_running = true;
+  m_thread  = std::thread{[this, generation = ++m_generation, alive = m_alive] { run(generation, alive); }};
+}
+//-----------------------------------------------------------------------
+/**
+ * stop
+ *
+ * The thread is taken out under the lock and joined outside it, so only one
+ * of several concurrent calls joins it. Called from a subscriber, on the
+ * polling thread, this only asks the loop to end after the current poll; the
+ * thread is joined on the next start() or on destruction.
+ */
+void ChatPoller::stop()
+{
+  std::thread thread{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_running = false;
+    if (m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id())
+      thread = std::exchange(m_thread, std::thread{});
+  }
+  m_condition.notify_all();
+
+  if (thread.joinable())
+    thread.join();
+}
+//-----------------------------------------------------------------------
+void ChatPoller::run(const uint64_t generation, const std::shared_ptr<bool> alive)
+{
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      const auto stopped = [this, generation] { return !m_running || m_generation != generation; };
+      m_condition.wait_until(lock, m_next_poll, stopped);
+      if (stopped())
+        return;
+    }
+    poll();
+    if (!*alive)
+      return;
+  }
+}
+//-----------------------------------------------------------------------
+bool ChatPoller::due() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return Clock::now() >= m_next_poll;
+}
+//-----------------------------------------------------------------------
+ChatPoller::Clock::time_point ChatPoller::next_poll() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_next_poll;
+}
+//-----------------------------------------------------------------------
+bool ChatPoller::running() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_running;
+}
+//-----------------------------------------------------------------------
+std::string ChatPoller::page_token() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_page_token;
+}
+//-----------------------------------------------------------------------
+std::chrono::milliseconds ChatPoller::interval() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_interval;
+}
+
+} // namespace ktube
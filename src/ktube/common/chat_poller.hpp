@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dedup.hpp"
+#include "pager.hpp"
+#include "types.hpp"
+
+namespace ktube {
+struct ChatPoll {
+Page<LiveMessage>         page;
+std::chrono::milliseconds interval;
+};
+
+/**
+ * ChatPoller
+ *
+ * Long-poll loop over liveChat/messages. Each poll sends the nextPageToken of
+ * the previous one, so the server only returns messages that arrived since,
+ * and the next poll waits for the pollingIntervalMillis the server asked for.
+ * New messages are handed to every subscriber; a message that was already
+ * delivered, by id or by falling behind the watermark, is dropped first.
+ *
+ * poll() can be driven by the caller, or start() runs the loop on its own
+ * thread until stop(). Subscribers are called on the polling thread.
+ */
+class ChatPoller {
+public:
+using Clock      = std::chrono::steady_clock;
+using Fetcher    = std::function<ChatPoll(const std::string& page_token)>;
+using Subscriber = std::function<void(const LiveMessages&)>;
+
+explicit ChatPoller(Fetcher fetch);
+~ChatPoller();
+
+ChatPoller(const ChatPoller&)            = delete;
+ChatPoller& operator=(const ChatPoller&) = delete;
+
+/**
+ * poll
+ *
+ * Fetches once and delivers any new messages. A failed fetch keeps the
+ * current page token so nothing is skipped or delivered twice. While a poll
+ * is in flight, another one returns 0 at once rather than fetching the same
+ * page token again.
+ *
+ * @returns [out] {std::size_t} number of new messages delivered
+ */
+std::size_t               poll();
+void                      subscribe(Subscriber subscriber);
+void                      start();
+void                      stop();
+bool                      due()        const;
+Clock::time_point         next_poll()  const;
+bool                      running()    const;
+std::string               page_token() const;
+std::chrono::milliseconds interval()   const;
+
+private:
+void run(const uint64_t generation, const std::shared_ptr<bool> alive);
+
+Fetcher                   m_fetch;
+std::vector<Subscriber>   m_subscribers;
+MessageIndex              m_seen;
+std::string               m_page_token;
+std::chrono::milliseconds m_interval;
+Clock::time_point         m_next_poll;
+std::thread               m_thread;
+bool                      m_running;
+bool                      m_polling;
+uint64_t                  m_generation;
+std::shared_ptr<bool>     m_alive; // false once destroyed on the polling thread
+mutable std::mutex        m_mutex;
+std::condition_variable   m_condition;
+};
+
+} // namespace ktube
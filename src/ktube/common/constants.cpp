@@ -23,10 +23,17 @@ const uint8_t COMMENT_REPLY_URL_INDEX    = 0x06;
 const uint8_t ACCEPT_HEADER_INDEX        = 0x00;
 const uint8_t AUTH_HEADER_INDEX          = 0x01;
 const uint8_t CONTENT_TYPE_INDEX         = 0x02;
+const uint8_t IF_NONE_MATCH_INDEX        = 0x03;
+const uint8_t ETAG_HEADER_INDEX          = 0x04;
+const uint8_t ACCEPT_ENCODING_INDEX      = 0x05;
+const uint8_t USER_AGENT_INDEX           = 0x06;
+const uint8_t CONTENT_ENCODING_INDEX     = 0x07;
 
 // Header Value Indexes
 const uint8_t APP_JSON_INDEX             = 0x00;
 const uint8_t FORM_URL_ENC_INDEX         = 0x01;
+const uint8_t GZIP_INDEX                 = 0x02;
+const uint8_t GZIP_USER_AGENT_INDEX      = 0x03;
 
 // Param Name Indexes
 const uint8_t PART_INDEX                 = 0x00;
@@ -44,6 +51,8 @@ const uint8_t ORDER_INDEX                = 0x0B;
 const uint8_t MAX_RESULT_INDEX           = 0x0C;
 const uint8_t QUERY_INDEX                = 0x0D;
 const uint8_t VIDEO_ID_INDEX             = 0x0E;
+const uint8_t PAGE_TOKEN_INDEX           = 0x0F;
+const uint8_t FIELDS_INDEX               = 0x10;
 
 // Param Value Indexes
 const uint8_t CHAN_KEY_INDEX             = 0x00;
@@ -62,6 +71,15 @@ const uint8_t VIEW_COUNT_INDEX           = 0x0C;
 const uint8_t SNIPPET_STATS_INDEX        = 0x0D;
 const uint8_t REPLIES_INDEX              = 0x0E;
 
+// Field Projection Indexes
+const uint8_t VIDEO_STATS_FIELDS_INDEX    = 0x00;
+const uint8_t CHANNEL_INFO_FIELDS_INDEX   = 0x01;
+const uint8_t SEARCH_VIDEO_FIELDS_INDEX   = 0x02;
+const uint8_t LIVE_VIDEO_FIELDS_INDEX     = 0x03;
+const uint8_t LIVE_DETAILS_FIELDS_INDEX   = 0x04;
+const uint8_t LIVE_CHAT_FIELDS_INDEX      = 0x05;
+const uint8_t COMMENT_THREAD_FIELDS_INDEX = 0x06;
+
 // Strings
 const std::vector<std::string> URL_VALUES{
   "https://www.googleapis.com/youtube/v3/search",
@@ -76,12 +94,19 @@ const std::vector<std::string> URL_VALUES{
 const std::vector<std::string> HEADER_NAMES{
   "Accept",
   "Authorization",
-  "Content-Type"
+  "Content-Type",
+  "If-None-Match",
+  "ETag",
+  "Accept-Encoding",
+  "User-Agent",
+  "Content-Encoding"
 };
 
 const std::vector<std::string> HEADER_VALUES{
   "application/json",
-  "application/x-www-form-urlencoded"
+  "application/x-www-form-urlencoded",
+  "gzip",
+  "ktube (gzip)"
 };
 
 const std::vector<std::string> PARAM_NAMES = {
@@ -99,7 +124,9 @@ const std::vector<std::string> PARAM_NAMES = {
   "order",
   "maxResults",
   "q",
-  "videoId"
+  "videoId",
+  "pageToken",
+  "fields"
 };
 
 const uint8_t KSTYLEYO_CHANNEL_ID_INDEX             = 0x00;
@@ -141,6 +168,19 @@ const std::vector<std::string> PARAM_VALUES{
   "replies"
 };
 
+// Partial responses: exactly the fields each decoder reads
+const std::vector<std::string> FIELD_VALUES{
+  "etag,items(id,snippet/tags,statistics(viewCount,likeCount,dislikeCount,commentCount))",
+  "etag,items(id,snippet(title,description,publishedAt,thumbnails/default/url),"
+    "statistics(viewCount,subscriberCount,videoCount))",
+  "nextPageToken,items(id/videoId,snippet(channelId,title,description,publishedAt))",
+  "items(id/videoId,snippet(title,description,channelTitle,channelId,thumbnails/high/url))",
+  "items/liveStreamingDetails/activeLiveChatId",
+  "nextPageToken,pollingIntervalMillis,items(id,snippet(publishedAt,authorChannelId,textMessageDetails/messageText))",
+  "nextPageToken,items(id,snippet(videoId,topLevelComment/snippet("
+    "textDisplay,authorDisplayName,authorChannelId/value,likeCount,publishedAt)))"
+};
+
 const std::string E_CHANNEL_ID{"UCFP7BAwQIzqml"};
 const std::string DEFAULT_CONFIG_PATH{"config/config.ini"};
 const std::string GOOGLE_CONFIG_SECTION{"google"};
@@ -156,6 +196,13 @@ const std::string YOUTUBE_USERNAME{"chat_name"};
 const std::string YOUTUBE_GREET{"greet"};
 const std::string YOUTUBE_TEST_MODE{"test_mode"};
 const std::string YOUTUBE_RETRY_MODE{"retry"};
+const std::string YOUTUBE_CHAT_CAPACITY{"chat_capacity"};
+const std::string YOUTUBE_CHAT_MAX_AGE{"chat_max_age"};
+const std::string YOUTUBE_ALIASES{"aliases"};
+const std::string YOUTUBE_KEYWORDS{"keywords"};
+const std::string YOUTUBE_CHAT_SEND_INTERVAL{"chat_send_interval"};
+const std::string YOUTUBE_CHAT_COALESCE{"chat_coalesce"};
+const std::string YOUTUBE_INTERACTIONS_PATH{"interactions_path"};
 const std::string CREDS_PATH_KEY{"credentials_path"};
 const std::string TOKENS_PATH_KEY{"token_path"};
 const std::string INSTAGRAM_CONFIG_SECTION{"instagram"};
@@ -174,6 +221,12 @@ const std::string support{"Please click like and subscribe!"};
 const std::string test_support{"I hope you are all having a good day."};
 } // namespace promotion
 
+namespace youtube {
+const std::vector<std::string> CHAT_COMMANDS{
+  "!q"
+};
+} // namespace youtube
+
 // const std::vector<std::string
 } // namespace constants
 } // namespace ktube
@@ -33,10 +33,17 @@ extern const uint8_t COMMENT_REPLY_URL_INDEX;
 extern const uint8_t ACCEPT_HEADER_INDEX;
 extern const uint8_t AUTH_HEADER_INDEX;
 extern const uint8_t CONTENT_TYPE_INDEX;
+extern const uint8_t IF_NONE_MATCH_INDEX;
+extern const uint8_t ETAG_HEADER_INDEX;
+extern const uint8_t ACCEPT_ENCODING_INDEX;
+extern const uint8_t USER_AGENT_INDEX;
+extern const uint8_t CONTENT_ENCODING_INDEX;
 
 // Header Value Indexes
 extern const uint8_t APP_JSON_INDEX;
 extern const uint8_t FORM_URL_ENC_INDEX;
+extern const uint8_t GZIP_INDEX;
+extern const uint8_t GZIP_USER_AGENT_INDEX;
 
 // Param Name Indexes
 extern const uint8_t PART_INDEX;
@@ -54,6 +61,8 @@ extern const uint8_t ORDER_INDEX;
 extern const uint8_t MAX_RESULT_INDEX;
 extern const uint8_t QUERY_INDEX;
 extern const uint8_t VIDEO_ID_INDEX;
+extern const uint8_t PAGE_TOKEN_INDEX;
+extern const uint8_t FIELDS_INDEX;
 
 // Param Value Indexes
 extern const uint8_t CHAN_KEY_INDEX;
@@ -71,6 +80,15 @@ extern const uint8_t CONTENT_DETAILS_INDEX;
 extern const uint8_t VIEW_COUNT_INDEX;
 extern const uint8_t SNIPPET_STATS_INDEX;
 
+// Field Projection Indexes
+extern const uint8_t VIDEO_STATS_FIELDS_INDEX;
+extern const uint8_t CHANNEL_INFO_FIELDS_INDEX;
+extern const uint8_t SEARCH_VIDEO_FIELDS_INDEX;
+extern const uint8_t LIVE_VIDEO_FIELDS_INDEX;
+extern const uint8_t LIVE_DETAILS_FIELDS_INDEX;
+extern const uint8_t LIVE_CHAT_FIELDS_INDEX;
+extern const uint8_t COMMENT_THREAD_FIELDS_INDEX;
+
 // URL Indexes
 extern const uint8_t SEARCH_URL_INDEX;
 extern const uint8_t VIDEOS_URL_INDEX;
@@ -111,6 +129,8 @@ extern const std::vector<std::string> PARAM_NAMES;
 
 extern const std::vector<std::string> PARAM_VALUES;
 
+extern const std::vector<std::string> FIELD_VALUES;
+
 extern const std::string E_CHANNEL_ID;
 extern const std::string DEFAULT_CONFIG_PATH;
 extern const std::string YOUTUBE_KEY;
@@ -121,6 +141,13 @@ extern const std::string YOUTUBE_USERNAME;
 extern const std::string YOUTUBE_GREET;
 extern const std::string YOUTUBE_TEST_MODE;
 extern const std::string YOUTUBE_RETRY_MODE;
+extern const std::string YOUTUBE_CHAT_CAPACITY;
+extern const std::string YOUTUBE_CHAT_MAX_AGE;
+extern const std::string YOUTUBE_ALIASES;
+extern const std::string YOUTUBE_KEYWORDS;
+extern const std::string YOUTUBE_CHAT_SEND_INTERVAL;
+extern const std::string YOUTUBE_CHAT_COALESCE;
+extern const std::string YOUTUBE_INTERACTIONS_PATH;
 
 namespace invitations {
 extern const std::string OFFER_TO_INQUIRE;
@@ -173,6 +200,8 @@ const uint8_t  COMMENT_LIST_QUOTA_INDEX   = 0x02;
 const uint8_t  SEARCH_LIST_QUOTA_INDEX    = 0x03;
 const uint8_t  COMMENT_INSERT_QUOTA_INDEX = 0x04;
 const uint8_t  COMMENT_REPLY_QUOTA_INDEX  = 0x05;
+const uint8_t  LIVE_CHAT_LIST_QUOTA_INDEX = 0x06;
+const uint8_t  LIVE_CHAT_POST_QUOTA_INDEX = 0x07;
 
 const std::vector<uint32_t> QUOTA_LIMIT{
   1,
@@ -180,10 +209,20 @@ const std::vector<uint32_t> QUOTA_LIMIT{
   1,
   100,
   50,
+  50,
+  5,
   50
 };
 
 const uint8_t YOUTUBE_VIDEO_ID_LENGTH     = 11;
+const uint8_t MAX_IDS_PER_REQUEST         = 50;
+const uint8_t MAX_SEARCH_RESULTS          = 50;
+const uint8_t MAX_COMMENT_RESULTS         = 100;
+const uint32_t DEFAULT_CHAT_POLL_INTERVAL_MS = 5000;
+const uint32_t DEFAULT_CHAT_SEND_INTERVAL_MS = 1000;
+const uint32_t MAX_CHAT_MESSAGE_LENGTH       = 200;
+
+extern const std::vector<std::string> CHAT_COMMANDS;
 } // namespace youtube
 } // namespace constants
 } // namespace ktube
\ No newline at end of file
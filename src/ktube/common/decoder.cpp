@@ -0,0 +1,250 @@
+#include "decoder.hpp"
+#include "schema.hpp"
+
+#include <charconv>
+
+#include "util.hpp"
+#include "youtube_util.hpp"
+
+namespace ktube {
+bool SaxDecoder::decode(const std::string_view text)
+{
+  m_arrays.clear();
+  m_key.clear();
+  m_skip = 0;
+
+  return nlohmann::json::sax_parse(text.begin(), text.end(), this);
+}
+//-----------------------------------------------------------------------
+bool SaxDecoder::number_integer(number_integer_t value)
+{
+  if (!m_skip && !m_arrays.empty() && value >= 0)
+    this->value(current_key(), static_cast<uint64_t>(value));
+  return true;
+}
+//-----------------------------------------------------------------------
+bool SaxDecoder::number_unsigned(number_unsigned_t value)
+{
+  if (!m_skip && !m_arrays.empty())
+    this->value(current_key(), static_cast<uint64_t>(value));
+  return true;
+}
+//-----------------------------------------------------------------------
+bool SaxDecoder::string(string_t& value)
+{
+  if (!m_skip && !m_arrays.empty())
+    this->value(current_key(), value);
+  return true;
+}
+//-----------------------------------------------------------------------
+bool SaxDecoder::key(string_t& key)
+{
+  if (!m_skip)
+    m_key.assign(key);
+  return true;
+}
+//-----------------------------------------------------------------------
+bool SaxDecoder::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e)
+{
+  log(std::string{"Failed to decode response: "} + e.what());
+  return false;
+}
+//-----------------------------------------------------------------------
+std::string_view SaxDecoder::current_key() const
+{
+  return (!m_arrays.empty() && m_arrays.back()) ? std::string_view{} : std::string_view{m_key};
+}
+//-----------------------------------------------------------------------
+bool SaxDecoder::start(const bool array)
+{
+  if (m_skip)
+    m_skip++;
+  else
+  if (!m_arrays.empty() && !enter(current_key()))
+    m_skip = 1;
+  else
+    m_arrays.push_back(array);
+
+  return true;
+}
+//-----------------------------------------------------------------------
+bool SaxDecoder::end()
+{
+  if (m_skip)
+  {
+    m_skip--;
+    return true;
+  }
+
+  m_arrays.pop_back();
+  if (!m_arrays.empty())
+    leave();
+
+  return true;
+}
+//-----------------------------------------------------------------------
+uint64_t ParseCount(const std::string_view digits)
+{
+  uint64_t count{0};
+  if (std::from_chars(digits.data(), digits.data() + digits.size(), count).ec != std::errc{})
+    return 0;
+  return count;
+}
+//-----------------------------------------------------------------------
+template <>
+struct Schema<Video> {
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&Video::id>         {"id.videoId"},
+  schema::Field<&Video::channel_id> {"snippet.channelId"},
+  schema::Field<&Video::title>      {"snippet.title"},
+  schema::Field<&Video::description>{"snippet.description"},
+  schema::Field<&Video::datetime>   {"snippet.publishedAt"}
+);
+
+static bool finish(Video& video)
+{
+  if (video.id.empty())
+    return false;
+
+  video.time = to_readable_time(video.datetime);
+  video.url  = youtube_id_to_url(video.id);
+  return true;
+}
+};
+
+template <>
+struct Schema<schema::Keyed<VideoStats>> {
+using Keyed = schema::Keyed<VideoStats>;
+
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&Keyed::key>                             {"id"},
+  schema::Field<&Keyed::value, &VideoStats::views>       {"statistics.viewCount"},
+  schema::Field<&Keyed::value, &VideoStats::likes>       {"statistics.likeCount"},
+  schema::Field<&Keyed::value, &VideoStats::dislikes>    {"statistics.dislikeCount"},
+  schema::Field<&Keyed::value, &VideoStats::comments>    {"statistics.commentCount"},
+  schema::Field<&Keyed::value, &VideoStats::keywords>    {"snippet.tags"}
+);
+
+static bool finish(Keyed& stats) { return !stats.key.empty(); }
+};
+
+template <>
+struct Schema<ChannelInfo> {
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&ChannelInfo::id>                                {"id"},
+  schema::Field<&ChannelInfo::name>                              {"snippet.title"},
+  schema::Field<&ChannelInfo::description>                       {"snippet.description"},
+  schema::Field<&ChannelInfo::created>                           {"snippet.publishedAt"},
+  schema::Field<&ChannelInfo::thumb_url>                         {"snippet.thumbnails.default.url"},
+  schema::Field<&ChannelInfo::stats, &ChannelStats::views>       {"statistics.viewCount"},
+  schema::Field<&ChannelInfo::stats, &ChannelStats::subscribers> {"statistics.subscriberCount"},
+  schema::Field<&ChannelInfo::stats, &ChannelStats::videos>      {"statistics.videoCount"}
+);
+
+static bool finish(ChannelInfo& channel) { return !channel.id.empty(); }
+};
+
+template <>
+struct Schema<Comment> : schema::Defaults {
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&Comment::id>      {"id"},
+  schema::Field<&Comment::video_id>{"snippet.videoId"},
+  schema::Field<&Comment::text>    {"snippet.topLevelComment.snippet.textDisplay"},
+  schema::Field<&Comment::name>    {"snippet.topLevelComment.snippet.authorDisplayName"},
+  schema::Field<&Comment::channel> {"snippet.topLevelComment.snippet.authorChannelId.value"},
+  schema::Field<&Comment::likes>   {"snippet.topLevelComment.snippet.likeCount"},
+  schema::Field<&Comment::time>    {"snippet.topLevelComment.snippet.publishedAt"}
+);
+};
+
+template <>
+struct Schema<LiveMessage> {
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&LiveMessage::id>       {"id"},
+  schema::Field<&LiveMessage::timestamp>{"snippet.publishedAt"},
+  schema::Field<&LiveMessage::author>   {"snippet.authorChannelId"},
+  schema::Field<&LiveMessage::text>     {"snippet.textMessageDetails.messageText"}
+);
+
+static bool finish(LiveMessage& message)
+{
+  if (message.id.empty())
+    return false;
+
+  message.published = to_epoch_ms(message.timestamp);
+  return true;
+}
+};
+
+template <>
+struct Schema<ChatPoll> {
+using Item = LiveMessage;
+
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&ChatPoll::page, &Page<LiveMessage>::next_page_token>{"nextPageToken"},
+  schema::Field<&ChatPoll::interval>                                 {"pollingIntervalMillis"},
+  schema::Field<&ChatPoll::page, &Page<LiveMessage>::items>          {"items"}
+);
+};
+
+/**
+ * VideoDetails are read from search results (id.videoId) and from videos
+ * (id, liveStreamingDetails)
+ */
+template <>
+struct Schema<VideoDetails> : schema::Defaults {
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&VideoDetails::id>           {"id"},
+  schema::Field<&VideoDetails::id>           {"id.videoId"},
+  schema::Field<&VideoDetails::chat_id>      {"liveStreamingDetails.activeLiveChatId"},
+  schema::Field<&VideoDetails::title>        {"snippet.title"},
+  schema::Field<&VideoDetails::description>  {"snippet.description"},
+  schema::Field<&VideoDetails::channel_title>{"snippet.channelTitle"},
+  schema::Field<&VideoDetails::channel_id>   {"snippet.channelId"},
+  schema::Field<&VideoDetails::thumbnail>    {"snippet.thumbnails.high.url"}
+);
+};
+//-----------------------------------------------------------------------
+Page<Video> DecodeVideoPage(const std::string_view text)
+{
+  return Decode<Page<Video>>(text);
+}
+//-----------------------------------------------------------------------
+VideoStatsMap DecodeVideoStats(const std::string_view text)
+{
+  VideoStatsMap stats{};
+  for (auto& item : Decode<Page<schema::Keyed<VideoStats>>>(text).items)
+    stats.insert_or_assign(std::move(item.key), std::move(item.value));
+  return stats;
+}
+//-----------------------------------------------------------------------
+ChannelInfoMap DecodeChannelInfo(const std::string_view text)
+{
+  ChannelInfoMap channels{};
+  for (auto& channel : Decode<Page<ChannelInfo>>(text).items)
+  {
+    std::string id = channel.id;
+    channels.insert_or_assign(std::move(id), std::move(channel));
+  }
+  return channels;
+}
+//-----------------------------------------------------------------------
+Page<Comment> DecodeCommentPage(const std::string_view text)
+{
+  return Decode<Page<Comment>>(text);
+}
+//-----------------------------------------------------------------------
+Page<VideoDetails> DecodeVideoDetails(const std::string_view text)
+{
+  return Decode<Page<VideoDetails>>(text);
+}
+//-----------------------------------------------------------------------
+ChatPoll DecodeChatPoll(const std::string_view text)
+{
+  ChatPoll poll = Decode<ChatPoll>(text);
+  if (poll.interval.count() <= 0)
+    poll.interval = std::chrono::milliseconds{constants::youtube::DEFAULT_CHAT_POLL_INTERVAL_MS};
+  return poll;
+}
+
+} // namespace ktube
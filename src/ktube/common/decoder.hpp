@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "types.hpp"
+#include "pager.hpp"
+#include "chat_poller.hpp"
+
+namespace ktube {
+/**
+ * SaxDecoder
+ *
+ * Base for decoders that fill our types straight from a response body.
+ * Instead of building a DOM, the parser reports each value as it is read,
+ * together with its key. Array elements have the empty key.
+ *
+ * enter() is asked before each object or array below the root, and leave()
+ * is called when one that was entered closes. Returning false from enter()
+ * skips the whole subtree without calling back into the decoder, so only
+ * the fields a decoder reads are ever copied out of the parser.
+ */
+class SaxDecoder : public nlohmann::json_sax<nlohmann::json> {
+public:
+bool null()                                                   override { return true; }
+bool boolean(bool)                                            override { return true; }
+bool number_integer(number_integer_t value)                   override;
+bool number_unsigned(number_unsigned_t value)                 override;
+bool number_float(number_float_t, const string_t&)            override { return true; }
+bool string(string_t& value)                                  override;
+bool binary(binary_t&)                                        override { return true; }
+bool start_object(std::size_t)                                override { return start(false); }
+bool end_object()                                             override { return end();        }
+bool start_array(std::size_t)                                 override { return start(true);  }
+bool end_array()                                              override { return end();        }
+bool key(string_t& key)                                       override;
+bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override;
+
+/**
+ * decode
+ *
+ * @param   [in]  {std::string_view} text
+ * @returns [out] {bool} false if text is not valid JSON
+ */
+bool decode(const std::string_view text);
+
+protected:
+virtual bool enter(const std::string_view key)                        { return false; }
+virtual void leave()                                                  {}
+virtual void value(const std::string_view key, std::string& text)     {}
+virtual void value(const std::string_view key, const uint64_t number) {}
+
+private:
+std::string_view current_key() const;
+bool             start(const bool array);
+bool             end();
+
+std::vector<bool> m_arrays; // one per open container
+std::string       m_key;
+std::size_t       m_skip{0};
+};
+
+/**
+ * ParseCount
+ *
+ * YouTube sends statistics as decimal strings. They are decoded once here,
+ * so comparisons downstream are integer compares. Malformed counts are 0.
+ *
+ * @param   [in]  {std::string_view} digits
+ * @returns [out] {uint64_t}
+ */
+uint64_t ParseCount(const std::string_view digits);
+
+/**
+ * Decoders for the search, videos, channels, commentThreads and
+ * liveChat/messages endpoints, generated from the Schemas in decoder.cpp.
+ * Invalid JSON decodes to an empty result.
+ */
+Page<Video>        DecodeVideoPage   (const std::string_view text);
+VideoStatsMap      DecodeVideoStats  (const std::string_view text);
+ChannelInfoMap     DecodeChannelInfo (const std::string_view text);
+Page<Comment>      DecodeCommentPage (const std::string_view text);
+Page<VideoDetails> DecodeVideoDetails(const std::string_view text);
+ChatPoll           DecodeChatPoll    (const std::string_view text);
+
+} // namespace ktube
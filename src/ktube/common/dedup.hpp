@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_set>
+
+#include "types.hpp"
+
+namespace ktube {
+/**
+ * MessageIndex
+ *
+ * Remembers which chat messages have already been seen. The most recent
+ * `capacity` message ids are kept in a hash set; anything published more
+ * than `window_ms` before the newest message seen so far (the watermark) is
+ * older than the set can vouch for and is treated as seen.
+ *
+ * Messages without an id are keyed by author, publish time and text.
+ */
+class MessageIndex {
+public:
+static constexpr std::size_t DEFAULT_CAPACITY{4096};
+static constexpr int64_t     DEFAULT_WINDOW_MS{5 * 60 * 1000};
+
+explicit MessageIndex(const std::size_t capacity  = DEFAULT_CAPACITY,
+                      const int64_t     window_ms = DEFAULT_WINDOW_MS)
+: m_capacity(capacity ? capacity : 1),
+  m_window_ms(window_ms),
+  m_watermark(0)
+{
+  m_ids.reserve(m_capacity);
+}
+
+/**
+ * insert
+ *
+ * @param   [in]  {LiveMessage} message
+ * @returns [out] {bool} true the first time a message is seen
+ */
+bool insert(const LiveMessage& message)
+{
+  if (m_watermark && message.published && message.published < m_watermark - m_window_ms)
+    return false;
+
+  std::string key = (message.id.empty()) ?
+                      message.author + '|' + std::to_string(message.published) + '|' + message.text :
+                      message.id;
+
+  if (!m_ids.insert(key).second)
+    return false;
+
+  m_order.emplace_back(std::move(key));
+  if (m_order.size() > m_capacity)
+  {
+    m_ids.erase(m_order.front());
+    m_order.pop_front();
+  }
+
+  m_watermark = std::max(m_watermark, message.published);
+
+  return true;
+}
+
+int64_t     watermark() const { return m_watermark;  }
+std::size_t size()      const { return m_ids.size(); }
+
+private:
+std::unordered_set<std::string> m_ids;
+std::deque<std::string>         m_order;
+std::size_t                     m_capacity;
+int64_t                         m_window_ms;
+int64_t                         m_watermark;
+};
+
+} // namespace ktube
@@ -0,0 +1,69 @@
+#include "executor.hpp"
+
+namespace ktube {
+static thread_local const Executor* g_current_executor{nullptr};
+//-----------------------------------------------------------------------
+Executor::Executor(const std::size_t workers)
+: m_stopped(false)
+{
+  const std::size_t count = workers ? workers : 1;
+  m_workers.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++)
+    m_workers.emplace_back([this] { run(); });
+}
+//-----------------------------------------------------------------------
+Executor::~Executor()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stopped = true;
+  }
+  m_condition.notify_all();
+
+  for (auto& worker : m_workers)
+    if (worker.joinable())
+      worker.join();
+}
+//-----------------------------------------------------------------------
+void Executor::enqueue(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_tasks.emplace_back(std::move(task));
+  }
+  m_condition.notify_one();
+}
+//-----------------------------------------------------------------------
+void Executor::run()
+{
+  g_current_executor = this;
+
+  for (;;)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_condition.wait(lock, [this] { return m_stopped || !m_tasks.empty(); });
+
+      if (m_stopped && m_tasks.empty())
+        return;
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+  }
+}
+//-----------------------------------------------------------------------
+bool Executor::in_worker() const
+{
+  return g_current_executor == this;
+}
+//-----------------------------------------------------------------------
+std::size_t Executor::size() const
+{
+  return m_workers.size();
+}
+
+} // namespace ktube
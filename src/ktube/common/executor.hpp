@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ktube {
+/**
+ * Executor
+ *
+ * Fixed-size worker pool used to run independent requests concurrently. The
+ * number of workers bounds how many requests are in flight at once, and is
+ * normally the size of the SessionPool the requests are issued through.
+ *
+ * Work submitted from inside a worker runs inline on that worker, so nested
+ * fan-outs cannot starve the pool waiting on each other.
+ */
+class Executor {
+public:
+explicit Executor(const std::size_t workers);
+~Executor();
+
+Executor(const Executor&)            = delete;
+Executor& operator=(const Executor&) = delete;
+
+/**
+ * submit
+ *
+ * @param   [in]  {F}         fn
+ * @returns [out] {std::future<R>}
+ */
+template <typename F, typename R = std::invoke_result_t<F>>
+std::future<R> submit(F&& fn)
+{
+  auto task   = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+  auto future = task->get_future();
+
+  if (in_worker())
+    (*task)();
+  else
+    enqueue([task] { (*task)(); });
+
+  return future;
+}
+
+/**
+ * map
+ *
+ * Runs fn over every input concurrently and returns the results in input
+ * order, regardless of the order in which the requests complete.
+ *
+ * @param   [in]  {Container} inputs
+ * @param   [in]  {F}         fn
+ * @returns [out] {std::vector<R>}
+ */
+template <typename Container, typename F,
+          typename R = std::invoke_result_t<F, typename Container::value_type&>>
+std::vector<R> map(Container& inputs, F&& fn)
+{
+  std::vector<std::future<R>> futures{};
+  std::vector<R>              results{};
+  futures.reserve(inputs.size());
+  results.reserve(inputs.size());
+
+  for (auto& input : inputs)
+    futures.emplace_back(submit([&fn, &input] { return fn(input); }));
+
+  for (auto& future : futures)
+    results.emplace_back(future.get());
+
+  return results;
+}
+
+std::size_t size()      const;
+bool        in_worker() const; // true on one of this executor's workers
+
+private:
+void enqueue(std::function<void()> task);
+void run();
+
+std::vector<std::thread>          m_workers;
+std::deque<std::function<void()>> m_tasks;
+std::mutex                        m_mutex;
+std::condition_variable           m_condition;
+bool                              m_stopped;
+};
+
+} // namespace ktube
@@ -0,0 +1,217 @@
+#include "interactions.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+#include "util.hpp"
+
+namespace ktube {
+uint32_t InternTable::intern(const std::string_view value)
+{
+  const std::size_t hash = std::hash<std::string_view>{}(value);
+  const uint32_t    slot = probe(value, hash);
+
+  if (!m_slots.empty() && m_slots[slot])
+    return m_slots[slot] - 1;
+
+  const uint32_t id = static_cast<uint32_t>(m_hashes.size());
+  m_arena.append(value);
+  m_offsets.push_back(static_cast<uint32_t>(m_arena.size()));
+  m_hashes.push_back(hash);
+
+  if ((m_hashes.size() + 1) * 4 > m_slots.size() * 3) // keep the table under 3/4 full
+    grow();
+  else
+    m_slots[slot] = id + 1;
+
+  return id;
+}
+//-----------------------------------------------------------------------
+uint32_t InternTable::find(const std::string_view value) const
+{
+  if (m_slots.empty())
+    return npos;
+
+  const uint32_t slot = probe(value, std::hash<std::string_view>{}(value));
+  return (m_slots[slot]) ? m_slots[slot] - 1 : npos;
+}
+//-----------------------------------------------------------------------
+std::string_view InternTable::at(const uint32_t id) const
+{
+  return std::string_view{m_arena}.substr(m_offsets[id], m_offsets[id + 1] - m_offsets[id]);
+}
+//-----------------------------------------------------------------------
+uint32_t InternTable::probe(const std::string_view value, const std::size_t hash) const
+{
+  if (m_slots.empty())
+    return 0;
+
+  const std::size_t mask = m_slots.size() - 1;
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask)
+  {
+    const uint32_t entry = m_slots[slot];
+    if (!entry || (m_hashes[entry - 1] == hash && at(entry - 1) == value))
+      return static_cast<uint32_t>(slot);
+  }
+}
+//-----------------------------------------------------------------------
+void InternTable::grow()
+{
+  std::vector<uint32_t> slots(std::max<std::size_t>(64, m_slots.size() * 2), 0);
+  const std::size_t     mask = slots.size() - 1;
+
+  for (uint32_t id = 0; id < m_hashes.size(); id++)
+  {
+    std::size_t slot = m_hashes[id] & mask;
+    while (slots[slot])
+      slot = (slot + 1) & mask;
+    slots[slot] = id + 1;
+  }
+
+  m_slots = std::move(slots);
+}
+//-----------------------------------------------------------------------
+InteractionStore::~InteractionStore()
+{
+  if (!m_path.empty())
+    save();
+}
+//-----------------------------------------------------------------------
+bool InteractionStore::open(const std::string& path)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_path = path;
+    m_journal.close();
+    load();
+  }
+  return save();
+}
+//-----------------------------------------------------------------------
+bool InteractionStore::save()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (m_path.empty())
+    return false;
+
+  const std::string temp = m_path + ".tmp";
+  {
+    std::ofstream file{temp, std::ios::trunc | std::ios::binary};
+    if (!file)
+    {
+      log("Unable to write interactions to " + m_path);
+      return false;
+    }
+    write(file, 'u', m_users,  m_user_flags);
+    write(file, 'v', m_values, m_value_flags);
+  }
+
+  m_journal.close();
+  if (std::rename(temp.c_str(), m_path.c_str()))
+    return false;
+
+  m_unflushed = 0;
+  m_journal.open(m_path, std::ios::app | std::ios::binary);
+  return m_journal.good();
+}
+//-----------------------------------------------------------------------
+void InteractionStore::record(const std::string_view user, const Interaction interaction, const std::string_view value)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  set(m_users, m_user_flags, 'u', user, Bit(interaction));
+  if (!value.empty())
+    set(m_values, m_value_flags, 'v', value, Bit(interaction));
+}
+//-----------------------------------------------------------------------
+bool InteractionStore::has_interacted(const std::string_view user, const Interaction interaction) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  const uint32_t              id = m_users.find(user);
+  return id != InternTable::npos && (m_user_flags[id] & Bit(interaction));
+}
+//-----------------------------------------------------------------------
+bool InteractionStore::has_discussed(const std::string_view value, const Interaction interaction) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  const uint32_t              id = m_values.find(value);
+  return id != InternTable::npos && (m_value_flags[id] & Bit(interaction));
+}
+//-----------------------------------------------------------------------
+std::size_t InteractionStore::users() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_users.size();
+}
+//-----------------------------------------------------------------------
+std::size_t InteractionStore::values() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_values.size();
+}
+//-----------------------------------------------------------------------
+void InteractionStore::set(InternTable&           table,
+                           std::vector<uint8_t>&  flags,
+                           const char             kind,
+                           const std::string_view key,
+                           const uint8_t          bits)
+{
+  const uint32_t id = table.intern(key);
+  if (id >= flags.size())
+    flags.resize(id + 1, 0);
+
+  if ((flags[id] & bits) == bits)
+    return;
+
+  flags[id] |= bits;
+
+  if (!m_journal.is_open())
+    return;
+
+  line(m_journal, kind, bits, key);
+  if (++m_unflushed >= JOURNAL_BATCH)
+  {
+    m_journal.flush();
+    m_unflushed = 0;
+  }
+}
+//-----------------------------------------------------------------------
+void InteractionStore::load()
+{
+  std::ifstream file{m_path, std::ios::binary};
+  char          kind{};
+  uint32_t      bits{};
+  std::size_t   length{};
+  std::string   key{};
+
+  // a record cut short by a crash ends the load; everything before it is kept
+  while (file >> kind >> bits >> length && file.get() == ' ')
+  {
+    key.resize(length);
+    if (!file.read(key.data(), length) || file.get() != '\n')
+      break;
+
+    if (kind == 'u')
+      set(m_users, m_user_flags, 'u', key, static_cast<uint8_t>(bits));
+    else
+    if (kind == 'v')
+      set(m_values, m_value_flags, 'v', key, static_cast<uint8_t>(bits));
+  }
+}
+//-----------------------------------------------------------------------
+void InteractionStore::line(std::ostream& stream, const char kind, const uint8_t bits, const std::string_view key)
+{
+  stream << kind << ' ' << static_cast<uint32_t>(bits) << ' ' << key.size() << ' ' << key << '\n';
+}
+//-----------------------------------------------------------------------
+void InteractionStore::write(std::ostream&               stream,
+                             const char                  kind,
+                             const InternTable&          table,
+                             const std::vector<uint8_t>& flags) const
+{
+  for (uint32_t id = 0; id < table.size(); id++)
+    if (flags[id])
+      line(stream, kind, flags[id], table.at(id));
+}
+
+} // namespace ktube
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ktube {
+/**
+ * InternTable
+ *
+ * Maps strings to dense ids 0, 1, 2... The strings are stored back to back
+ * in one arena. Lookups go through a flat open-addressing table of ids with
+ * linear probing, so interning never allocates per string and an id costs
+ * four bytes wherever it is stored.
+ */
+class InternTable {
+public:
+static constexpr uint32_t npos{UINT32_MAX};
+
+/**
+ * intern
+ *
+ * @param   [in]  {std::string_view} value
+ * @returns [out] {uint32_t}         id of value, added if it was not there
+ */
+uint32_t intern(const std::string_view value);
+
+/**
+ * find
+ *
+ * @param   [in]  {std::string_view} value
+ * @returns [out] {uint32_t}         id of value, or npos
+ */
+uint32_t         find(const std::string_view value) const;
+std::string_view at(const uint32_t id)              const;
+std::size_t      size()                             const { return m_hashes.size(); }
+
+private:
+uint32_t probe(const std::string_view value, const std::size_t hash) const;
+void     grow();
+
+std::string           m_arena;
+std::vector<uint32_t> m_offsets{0};
+std::vector<size_t>   m_hashes;
+std::vector<uint32_t> m_slots; // id + 1, 0 for an empty slot
+};
+
+/**
+ * InteractionStore
+ *
+ * Remembers which interactions the bot has had with each chatter and which
+ * values (people, places, organisations) have come up. Users and values are
+ * interned once. Each one's history is a byte of Interaction bits indexed
+ * by its id.
+ *
+ * open() attaches a snapshot file. Its contents are loaded and every new
+ * bit is appended to it as one record, so a restart does not forget who was
+ * already greeted. A record is "kind bits length key" followed by a newline;
+ * the key is length-prefixed so any bytes in it survive a reload. Appends
+ * are flushed every JOURNAL_BATCH records and by save(), which rewrites the
+ * file compactly, as does the destructor.
+ */
+class InteractionStore {
+public:
+static constexpr std::size_t JOURNAL_BATCH{32};
+
+InteractionStore() = default;
+~InteractionStore();
+
+InteractionStore(const InteractionStore&)            = delete;
+InteractionStore& operator=(const InteractionStore&) = delete;
+
+/**
+ * open
+ *
+ * @param   [in]  {std::string} path
+ * @returns [out] {bool}        false if the snapshot cannot be written
+ */
+bool        open(const std::string& path);
+bool        save();
+
+/**
+ * record
+ *
+ * @param [in] {std::string_view} user
+ * @param [in] {Interaction}      interaction
+ * @param [in] {std::string_view} value (optional) what the interaction was about
+ */
+void        record(const std::string_view user, const Interaction interaction, const std::string_view value = {});
+bool        has_interacted(const std::string_view user, const Interaction interaction) const;
+bool        has_discussed(const std::string_view value, const Interaction interaction) const;
+std::size_t users()  const;
+std::size_t values() const;
+
+private:
+static uint8_t Bit(const Interaction interaction) { return static_cast<uint8_t>(1u << interaction); }
+
+void set(InternTable&          table,
+         std::vector<uint8_t>& flags,
+         const char            kind,
+         const std::string_view key,
+         const uint8_t         bits);
+void load();
+static void line(std::ostream& stream, const char kind, const uint8_t bits, const std::string_view key);
+void write(std::ostream& stream, const char kind, const InternTable& table, const std::vector<uint8_t>& flags) const;
+
+InternTable          m_users;
+std::vector<uint8_t> m_user_flags;
+InternTable          m_values;
+std::vector<uint8_t> m_value_flags;
+std::string          m_path;
+std::ofstream        m_journal;
+std::size_t          m_unflushed{0};
+mutable std::mutex   m_mutex;
+};
+
+} // namespace ktube
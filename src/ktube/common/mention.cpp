@@ -0,0 +1,85 @@
+#include "mention.hpp"
+
+#include <deque>
+
+namespace ktube {
+uint32_t MentionMatcher::add(const std::string& pattern, const MentionType type)
+{
+  m_patterns.emplace_back(Pattern{pattern, type});
+  m_states.clear();
+  return static_cast<uint32_t>(m_patterns.size() - 1);
+}
+//-----------------------------------------------------------------------
+void MentionMatcher::build()
+{
+  m_states.clear();
+  m_states.emplace_back();
+  m_states.front().next.fill(-1);
+
+  for (uint32_t index = 0; index < m_patterns.size(); index++)
+  {
+    const std::string& text = m_patterns[index].text;
+    if (text.empty())
+      continue;
+
+    int32_t state{0};
+    for (const char c : text)
+    {
+      const uint8_t byte = Fold(c);
+      if (m_states[state].next[byte] < 0)
+      {
+        m_states[state].next[byte] = static_cast<int32_t>(m_states.size());
+        m_states.emplace_back();
+        m_states.back().next.fill(-1);
+      }
+      state = m_states[state].next[byte];
+    }
+    m_states[state].patterns.push_back(index);
+  }
+
+  std::deque<int32_t> queue{};
+
+  for (auto& next : m_states.front().next)
+  {
+    if (next < 0)
+      next = 0;
+    else
+    {
+      m_states[next].fail = 0;
+      queue.push_back(next);
+    }
+  }
+
+  while (!queue.empty())
+  {
+    const int32_t state = queue.front();
+    queue.pop_front();
+
+    State& current = m_states[state];
+    current.output     = current.patterns.empty() ? m_states[current.fail].output : state;
+    current.dictionary = m_states[current.fail].output;
+
+    for (std::size_t byte = 0; byte < current.next.size(); byte++)
+    {
+      const int32_t child = m_states[state].next[byte];
+      const int32_t fall  = m_states[m_states[state].fail].next[byte];
+
+      if (child < 0)
+        m_states[state].next[byte] = fall;
+      else
+      {
+        m_states[child].fail = fall;
+        queue.push_back(child);
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------
+bool MentionMatcher::contains(const std::string_view text) const
+{
+  bool found{false};
+  scan(text, [&found](const MentionMatch&) { found = true; });
+  return found;
+}
+
+} // namespace ktube
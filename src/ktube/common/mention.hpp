@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ktube {
+enum class MentionType
+{
+  name    = 0x00,
+  alias   = 0x01,
+  command = 0x02,
+  keyword = 0x03
+};
+//-----------------------------------------------------------------------
+struct MentionMatch
+{
+  uint32_t    pattern; // index passed back to MentionMatcher::pattern
+  MentionType type;
+  std::size_t offset;  // byte offset of the match in the text
+};
+//-----------------------------------------------------------------------
+struct ChatMention
+{
+  std::string_view chat_id;
+  uint64_t         message; // ChatBuffer sequence number
+  MentionMatch     match;
+};
+
+/**
+ * MentionMatcher
+ *
+ * Aho-Corasick automaton over every pattern the bot listens for: its name,
+ * aliases, chat commands and watch keywords. Scanning a message is a single
+ * pass over its bytes whatever the number of patterns, and reports every
+ * occurrence of every pattern. ASCII letters match case-insensitively.
+ *
+ * Commands only match at the start of a word, so "!q" does not fire inside
+ * "abc!q". Names and aliases only match as whole words, so "bot" does not
+ * fire inside "robot" or "botany".
+ */
+class MentionMatcher {
+public:
+/**
+ * add
+ *
+ * @param   [in]  {std::string} pattern
+ * @param   [in]  {MentionType} type
+ * @returns [out] {uint32_t}    index of the pattern
+ */
+uint32_t add(const std::string& pattern, const MentionType type);
+
+/**
+ * build
+ *
+ * Must be called after the last add() and before scan()
+ */
+void build();
+
+/**
+ * scan
+ *
+ * @param [in] {std::string_view} text
+ * @param [in] {F}                fn   void(const MentionMatch&)
+ */
+template <typename F>
+void scan(const std::string_view text, F&& fn) const
+{
+  if (m_states.empty())
+    return;
+
+  int32_t state{0};
+  for (std::size_t i = 0; i < text.size(); i++)
+  {
+    state = m_states[state].next[Fold(text[i])];
+
+    for (int32_t out = m_states[state].output; out >= 0; out = m_states[out].dictionary)
+      for (const uint32_t pattern : m_states[out].patterns)
+      {
+        const Pattern&    p     = m_patterns[pattern];
+        const std::size_t start = i + 1 - p.text.size();
+
+        if (p.type == MentionType::command && start > 0 && !IsSpace(text[start - 1]))
+          continue;
+
+        if ((p.type == MentionType::name || p.type == MentionType::alias) &&
+            ((start > 0 && IsWord(text[start - 1])) || (i + 1 < text.size() && IsWord(text[i + 1]))))
+          continue;
+
+        fn(MentionMatch{pattern, p.type, start});
+      }
+  }
+}
+
+/**
+ * contains
+ *
+ * @param   [in]  {std::string_view} text
+ * @returns [out] {bool} true if any pattern occurs in text
+ */
+bool contains(const std::string_view text) const;
+
+const std::string& pattern(const uint32_t index) const { return m_patterns.at(index).text; }
+std::size_t        size()                        const { return m_patterns.size();        }
+bool               empty()                       const { return m_patterns.empty();       }
+
+private:
+struct Pattern {
+std::string text;
+MentionType type;
+};
+
+struct State {
+std::array<int32_t, 256> next;
+int32_t                  fail{0};
+int32_t                  output{-1};     // this state if it ends a pattern, else the nearest suffix that does
+int32_t                  dictionary{-1}; // next shorter suffix state that ends a pattern
+std::vector<uint32_t>    patterns;
+};
+
+static uint8_t Fold(const char c)
+{
+  const uint8_t byte = static_cast<uint8_t>(c);
+  return (byte >= 'A' && byte <= 'Z') ? byte + ('a' - 'A') : byte;
+}
+
+static bool IsSpace(const char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool IsWord(const char c)
+{
+  const uint8_t byte = Fold(c);
+  return (byte >= 'a' && byte <= 'z') || (byte >= '0' && byte <= '9') || byte == '_';
+}
+
+std::vector<Pattern> m_patterns;
+std::vector<State>   m_states;
+};
+
+} // namespace ktube
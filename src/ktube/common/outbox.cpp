@@ -0,0 +1,172 @@
+#include "outbox.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace ktube {
+ChatOutbox::ChatOutbox(Sender send, OutboxPolicy policy, const std::size_t send_workers)
+: m_send(std::move(send)),
+  m_policy(policy),
+  m_running(true),
+  m_in_flight(0),
+  m_senders(send_workers) {}
+//-----------------------------------------------------------------------
+ChatOutbox::~ChatOutbox()
+{
+  stop();
+}
+//-----------------------------------------------------------------------
+std::future<bool> ChatOutbox::post(const std::string& chat_id, std::string text, const bool coalesce)
+{
+  auto              promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future  = promise->get_future();
+
+  post(chat_id, std::move(text), [promise](bool sent) { promise->set_value(sent); }, coalesce);
+
+  return future;
+}
+//-----------------------------------------------------------------------
+void ChatOutbox::post(const std::string& chat_id, std::string text, Callback callback, const bool coalesce)
+{
+  bool queued{false};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_running)
+    {
+      m_chats[chat_id].queue.emplace_back(Pending{std::move(text), std::move(callback), coalesce});
+      queued = true;
+
+      if (!m_thread.joinable())
+        m_thread = std::thread{[this] { run(); }};
+    }
+  }
+
+  if (queued)
+    m_condition.notify_all();
+  else
+  if (callback)
+    callback(false);
+}
+//-----------------------------------------------------------------------
+void ChatOutbox::set_policy(OutboxPolicy policy)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_policy = policy;
+}
+//-----------------------------------------------------------------------
+OutboxPolicy ChatOutbox::policy() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_policy;
+}
+//-----------------------------------------------------------------------
+OutboxStats ChatOutbox::stats() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  OutboxStats                 stats = m_stats;
+  for (const auto& [chat_id, chat] : m_chats)
+    stats.pending += chat.queue.size();
+  return stats;
+}
+//-----------------------------------------------------------------------
+void ChatOutbox::stop()
+{
+  std::vector<Callback> dropped{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_running = false;
+  }
+  m_condition.notify_all();
+
+  if (m_thread.joinable())
+    m_thread.join();
+
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_condition.wait(lock, [this] { return m_in_flight == 0; });
+    for (auto& [chat_id, chat] : m_chats)
+      for (auto& pending : chat.queue)
+        dropped.emplace_back(std::move(pending.done));
+    m_chats.clear();
+  }
+
+  for (const auto& done : dropped)
+    if (done)
+      done(false);
+}
+//-----------------------------------------------------------------------
+void ChatOutbox::run()
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  while (m_running)
+  {
+    auto              ready = m_chats.end();
+    Clock::time_point wake  = Clock::time_point::max();
+
+    for (auto it = m_chats.begin(); it != m_chats.end(); it++)
+      if (!it->second.sending && !it->second.queue.empty() && it->second.next_send < wake)
+      {
+        wake  = it->second.next_send;
+        ready = it;
+      }
+
+    if (ready == m_chats.end())
+    {
+      m_condition.wait(lock);
+      continue;
+    }
+
+    if (wake > Clock::now())
+    {
+      m_condition.wait_until(lock, wake);
+      continue;
+    }
+
+    Chat&                 chat  = ready->second;
+    const std::string     chat_id{ready->first};
+    std::string           text  = std::move(chat.queue.front().text);
+    const bool            join  = m_policy.coalesce && chat.queue.front().coalesce;
+    std::vector<Callback> done{std::move(chat.queue.front().done)};
+    chat.queue.pop_front();
+
+    while (join && !chat.queue.empty() && chat.queue.front().coalesce &&
+           text.size() + std::char_traits<char>::length(SEPARATOR) + chat.queue.front().text.size() <= m_policy.max_length)
+    {
+      text += SEPARATOR;
+      text += chat.queue.front().text;
+      done.emplace_back(std::move(chat.queue.front().done));
+      chat.queue.pop_front();
+    }
+
+    chat.sending = true;
+    m_in_flight++;
+    m_senders.submit([this, chat_id, text = std::move(text), done = std::move(done)] { deliver(chat_id, text, done); });
+  }
+}
+//-----------------------------------------------------------------------
+void ChatOutbox::deliver(const std::string& chat_id, const std::string& text, const std::vector<Callback>& done)
+{
+  const bool sent = m_send(chat_id, text);
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    Chat&                       chat = m_chats[chat_id];
+    chat.next_send = Clock::now() + m_policy.interval;
+    chat.sending   = false;
+    m_in_flight--;
+    m_stats.posts++;
+    m_stats.coalesced += done.size() - 1;
+    if (sent)
+      m_stats.messages += done.size();
+    else
+      m_stats.failures += done.size();
+
+    m_condition.notify_all();
+  }
+
+  for (const auto& callback : done)
+    if (callback)
+      callback(sent);
+}
+
+} // namespace ktube
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "executor.hpp"
+
+namespace ktube {
+struct OutboxPolicy {
+std::chrono::milliseconds interval;   // minimum gap between two posts to the same chat
+std::size_t               max_length; // longest message a coalesced post may grow to
+bool                      coalesce;
+};
+
+struct OutboxStats {
+std::size_t pending{0};
+uint64_t    posts{0};     // requests sent
+uint64_t    messages{0};  // messages delivered, coalesced ones included
+uint64_t    coalesced{0}; // messages that rode along in another post
+uint64_t    failures{0};
+};
+
+/**
+ * ChatOutbox
+ *
+ * Posts chat messages in the background. Each chat has its own queue and
+ * sends at most once per policy interval, so a burst of replies to one chat
+ * never delays the others. Sends run on a small pool, one in flight per
+ * chat, so a slow post to one chat does not hold up a chat that is ready.
+ * Coalescing is opt-in: when both the policy and the message allow it,
+ * messages that queued up during the wait are joined into one post, up to
+ * max_length. Every message gets the result of the post that carried it,
+ * through a future or a callback.
+ */
+class ChatOutbox {
+public:
+using Clock    = std::chrono::steady_clock;
+using Sender   = std::function<bool(const std::string& chat_id, const std::string& text)>;
+using Callback = std::function<void(bool sent)>;
+
+static constexpr const char* SEPARATOR{" | "};
+static constexpr std::size_t SEND_WORKERS{4};
+
+ChatOutbox(Sender send, OutboxPolicy policy, const std::size_t send_workers = SEND_WORKERS);
+~ChatOutbox();
+
+ChatOutbox(const ChatOutbox&)            = delete;
+ChatOutbox& operator=(const ChatOutbox&) = delete;
+
+/**
+ * post
+ *
+ * @param   [in]  {std::string} chat_id
+ * @param   [in]  {std::string} text
+ * @param   [in]  {bool}        coalesce may be joined with neighbouring messages
+ * @returns [out] {std::future<bool>}
+ */
+std::future<bool> post(const std::string& chat_id, std::string text, const bool coalesce = false);
+void              post(const std::string& chat_id, std::string text, Callback callback, const bool coalesce = false);
+
+void              set_policy(OutboxPolicy policy);
+OutboxPolicy      policy() const;
+OutboxStats       stats()  const;
+
+/**
+ * stop
+ *
+ * Stops the worker and waits for sends in flight. Messages still queued are
+ * reported as not sent.
+ */
+void              stop();
+
+private:
+struct Pending {
+std::string text;
+Callback    done;
+bool        coalesce;
+};
+
+struct Chat {
+std::deque<Pending> queue;
+Clock::time_point   next_send;
+bool                sending{false};
+};
+
+void run();
+void deliver(const std::string& chat_id, const std::string& text, const std::vector<Callback>& done);
+
+Sender                      m_send;
+OutboxPolicy                m_policy;
+std::map<std::string, Chat> m_chats;
+OutboxStats                 m_stats;
+bool                        m_running;
+std::size_t                 m_in_flight;
+std::thread                 m_thread;
+mutable std::mutex          m_mutex;
+std::condition_variable     m_condition;
+Executor                    m_senders; // last: drained before the rest is destroyed
+};
+
+} // namespace ktube
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "executor.hpp"
+
+namespace ktube {
+template <typename T>
+struct Page {
+std::vector<T> items;
+std::string    next_page_token;
+};
+
+/**
+ * Pager
+ *
+ * Lazy range over a paginated list endpoint. A page is only requested when
+ * the consumer advances past the end of the previous one, and only one page
+ * is held at a time. Breaking out of a loop early stops the walk.
+ *
+ * With an Executor, the page after the current one is requested in the
+ * background as soon as the current page is delivered.
+ *
+ * A fetch that returns no items but the token it was given has not been
+ * served yet, e.g. its quota was queued on a worker that could not wait. A
+ * prefetched page like that is requested again on the consumer's thread;
+ * if that fails too, the walk ends.
+ *
+ *   for (const Comment& comment : api.PageVideoComments(id))
+ *     ...
+ */
+template <typename T>
+class Pager {
+public:
+using Fetcher = std::function<Page<T>(const std::string& page_token)>;
+
+class iterator {
+public:
+using iterator_category = std::input_iterator_tag;
+using value_type        = T;
+using difference_type   = std::ptrdiff_t;
+using pointer           = T*;
+using reference         = T&;
+
+iterator(Pager* pager = nullptr)
+: m_pager(pager),
+  m_index(0)
+{
+  if (m_pager && m_pager->m_page.items.empty() && !m_pager->advance())
+    m_pager = nullptr;
+}
+
+reference operator*()  const { return m_pager->m_page.items[m_index];  }
+pointer   operator->() const { return &m_pager->m_page.items[m_index]; }
+
+iterator& operator++()
+{
+  if (++m_index >= m_pager->m_page.items.size())
+  {
+    m_index = 0;
+    if (!m_pager->advance())
+      m_pager = nullptr;
+  }
+  return *this;
+}
+
+bool operator==(const iterator& other) const { return m_pager == other.m_pager && m_index == other.m_index; }
+bool operator!=(const iterator& other) const { return !(*this == other); }
+
+private:
+Pager*      m_pager;
+std::size_t m_index;
+};
+
+/**
+ * @param [in] {Fetcher}     fetch     Requests one page for a page token
+ * @param [in] {std::size_t} max_pages Stop after this many pages (0 for no limit)
+ * @param [in] {Executor*}   prefetch  Fetch the following page in the background
+ */
+explicit Pager(Fetcher fetch, const std::size_t max_pages = 0, Executor* prefetch = nullptr)
+: m_fetch(std::move(fetch)),
+  m_executor(prefetch),
+  m_max_pages(max_pages),
+  m_pages(0),
+  m_started(false),
+  m_done(false) {}
+
+Pager(Pager&&)                 = default;
+Pager(const Pager&)            = delete;
+Pager& operator=(const Pager&) = delete;
+
+~Pager()
+{
+  if (m_prefetched.valid())
+    m_prefetched.wait();
+}
+
+iterator begin() { return iterator{this}; }
+iterator end()   { return iterator{};     }
+
+/**
+ * advance
+ *
+ * Replaces the current page with the next non-empty one
+ *
+ * @returns [out] {bool} false once there are no more pages
+ */
+bool advance()
+{
+  do
+  {
+    if (m_done || (m_started && m_page.next_page_token.empty()) || (m_max_pages && m_pages >= m_max_pages))
+    {
+      m_done = true;
+      m_page = Page<T>{};
+      return false;
+    }
+
+    const std::string token      = m_page.next_page_token;
+    const bool        prefetched = m_prefetched.valid();
+
+    m_page = (prefetched) ? m_prefetched.get() : m_fetch(token);
+    if (prefetched && deferred(token))
+      m_page = m_fetch(token);
+
+    if (deferred(token))
+    {
+      m_done = true;
+      m_page = Page<T>{};
+      return false;
+    }
+
+    m_started = true;
+    m_pages++;
+
+    if (m_executor && !m_page.next_page_token.empty() && (!m_max_pages || m_pages < m_max_pages))
+      m_prefetched = m_executor->submit([fetch = m_fetch, token = m_page.next_page_token] { return fetch(token); });
+  }
+  while (m_page.items.empty());
+
+  return true;
+}
+
+/**
+ * stop
+ *
+ * Ends the walk. Any page already being prefetched is discarded.
+ */
+void stop()
+{
+  m_done = true;
+}
+
+const std::vector<T>& page()  const { return m_page.items; }
+std::size_t           pages() const { return m_pages;      }
+
+private:
+bool deferred(const std::string& token) const
+{
+  return m_page.items.empty() && !token.empty() && m_page.next_page_token == token;
+}
+
+Fetcher               m_fetch;
+Executor*             m_executor;
+std::future<Page<T>>  m_prefetched;
+Page<T>               m_page;
+std::size_t           m_max_pages;
+std::size_t           m_pages;
+bool                  m_started;
+bool                  m_done;
+};
+
+} // namespace ktube
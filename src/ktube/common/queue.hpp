@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace ktube {
+/**
+ * BoundedQueue
+ *
+ * Fixed-capacity lock-free queue. It is a ring of cells, each carrying a
+ * sequence number that says whether the cell is ready to be written or read
+ * in the current lap. Producers and consumers claim positions with a CAS on
+ * their own counter and never wait on each other. Any number of producers
+ * and consumers may share it, so it serves as both the MPSC and the SPSC
+ * link between pipeline stages.
+ *
+ * A full queue never blocks. try_push returns false and counts a stall, and
+ * the producer decides whether to drop, retry or back off.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+explicit BoundedQueue(const std::size_t capacity)
+: m_mask(RoundUp(capacity) - 1),
+  m_cells(new Cell[m_mask + 1]),
+  m_enqueue(0),
+  m_dequeue(0),
+  m_stalls(0)
+{
+  for (std::size_t i = 0; i <= m_mask; i++)
+    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+BoundedQueue(const BoundedQueue&)            = delete;
+BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+/**
+ * try_push
+ *
+ * @param   [in]  {U}    value moved from only if the push succeeds
+ * @returns [out] {bool} false if the queue is full
+ */
+template <typename U>
+bool try_push(U&& value)
+{
+  Cell*       cell;
+  std::size_t position = m_enqueue.load(std::memory_order_relaxed);
+
+  for (;;)
+  {
+    cell = &m_cells[position & m_mask];
+    const std::size_t    sequence = cell->sequence.load(std::memory_order_acquire);
+    const std::ptrdiff_t lap      = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+    if (lap == 0)
+    {
+      if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    }
+    else
+    if (lap < 0)
+    {
+      m_stalls.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else
+      position = m_enqueue.load(std::memory_order_relaxed);
+  }
+
+  cell->value = std::forward<U>(value);
+  cell->sequence.store(position + 1, std::memory_order_release);
+
+  return true;
+}
+
+/**
+ * try_pop
+ *
+ * @param   [out] {T}    value
+ * @returns [out] {bool} false if the queue is empty
+ */
+bool try_pop(T& value)
+{
+  Cell*       cell;
+  std::size_t position = m_dequeue.load(std::memory_order_relaxed);
+
+  for (;;)
+  {
+    cell = &m_cells[position & m_mask];
+    const std::size_t    sequence = cell->sequence.load(std::memory_order_acquire);
+    const std::ptrdiff_t lap      = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+    if (lap == 0)
+    {
+      if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    }
+    else
+    if (lap < 0)
+      return false;
+    else
+      position = m_dequeue.load(std::memory_order_relaxed);
+  }
+
+  value = std::move(cell->value);
+  cell->sequence.store(position + m_mask + 1, std::memory_order_release);
+
+  return true;
+}
+
+/**
+ * size
+ *
+ * @returns [out] {std::size_t} approximate depth while other threads are active
+ */
+std::size_t size() const
+{
+  const std::size_t enqueued = m_enqueue.load(std::memory_order_relaxed);
+  const std::size_t dequeued = m_dequeue.load(std::memory_order_relaxed);
+  return (enqueued > dequeued) ? enqueued - dequeued : 0;
+}
+
+bool        empty()    const { return size() == 0;                               }
+std::size_t capacity() const { return m_mask + 1;                                }
+uint64_t    stalls()   const { return m_stalls.load(std::memory_order_relaxed);  }
+
+private:
+struct Cell {
+std::atomic<std::size_t> sequence;
+T                        value;
+};
+
+static std::size_t RoundUp(const std::size_t capacity)
+{
+  std::size_t size{2};
+  while (size < capacity)
+    size <<= 1;
+  return size;
+}
+
+const std::size_t                     m_mask;
+std::unique_ptr<Cell[]>               m_cells;
+alignas(64) std::atomic<std::size_t>  m_enqueue;
+alignas(64) std::atomic<std::size_t>  m_dequeue;
+alignas(64) std::atomic<uint64_t>     m_stalls;
+};
+
+} // namespace ktube
@@ -0,0 +1,254 @@
+#include "quota.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "util.hpp"
+
+namespace ktube {
+static const std::time_t SECONDS_PER_DAY{86400};
+static const std::time_t PACE_WINDOW{3600};
+static const std::time_t WINDOWS_PER_DAY{SECONDS_PER_DAY / PACE_WINDOW};
+static const double      PACE_HEADROOM{0.05};
+static const double      PRIORITY_SHARE[]{1.00, 0.95, 0.80, 0.50};
+static const bool        PRIORITY_PACED[]{false, false, true, true};
+//-----------------------------------------------------------------------
+static unsigned NthSunday(const int year, const unsigned month, const unsigned n)
+{
+  const std::time_t weekday = (days_from_civil(year, month, 1) + 4) % 7; // 1970-01-01 was a Thursday
+  return 1 + static_cast<unsigned>((7 - weekday) % 7) + 7 * (n - 1);
+}
+//-----------------------------------------------------------------------
+PacificDay ToPacificDay(const std::time_t utc)
+{
+  const std::time_t standard = utc - 8 * 3600;
+  std::tm           tm{};
+  gmtime_r(&standard, &tm);
+
+  const int         year      = tm.tm_year + 1900;
+  const std::time_t dst_start = days_from_civil(year,  3, NthSunday(year,  3, 2)) * SECONDS_PER_DAY + 2 * 3600;
+  const std::time_t dst_end   = days_from_civil(year, 11, NthSunday(year, 11, 1)) * SECONDS_PER_DAY + 1 * 3600;
+  const std::time_t local     = standard + ((standard >= dst_start && standard < dst_end) ? 3600 : 0);
+
+  char date[11];
+  gmtime_r(&local, &tm);
+  std::strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+
+  return PacificDay{
+    .date    = date,
+    .elapsed = ((local % SECONDS_PER_DAY) + SECONDS_PER_DAY) % SECONDS_PER_DAY
+  };
+}
+//-----------------------------------------------------------------------
+QuotaManager::QuotaManager(std::string path, const uint32_t daily_limit)
+: m_path(std::move(path)),
+  m_day(ToPacificDay(std::time(nullptr)).date),
+  m_limit(daily_limit),
+  m_used(0),
+  m_calls(constants::youtube::QUOTA_LIMIT.size(), 0),
+  m_window(-1),
+  m_window_used(0),
+  m_version(0),
+  m_saved_version(0)
+{
+  load();
+}
+//-----------------------------------------------------------------------
+QuotaManager::~QuotaManager()
+{
+  flush();
+}
+//-----------------------------------------------------------------------
+Admission QuotaManager::evaluate(const uint8_t endpoint, const QuotaPriority priority, const std::time_t now)
+{
+  const PacificDay day = ToPacificDay(now);
+  Admission        result;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    roll(day);
+    result = admission(constants::youtube::QUOTA_LIMIT.at(endpoint), priority, day.elapsed);
+  }
+  save(false);
+  return result;
+}
+//-----------------------------------------------------------------------
+Admission QuotaManager::acquire(const uint8_t endpoint, const QuotaPriority priority, std::chrono::seconds max_wait)
+{
+  const uint32_t          cost     = constants::youtube::QUOTA_LIMIT.at(endpoint);
+  const Clock::time_point deadline = Clock::now() + max_wait;
+  Admission               result{Admission::queue};
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    for (bool waiting = true; waiting;)
+    {
+      const Clock::time_point now = Clock::now();
+      const PacificDay        day = ToPacificDay(Clock::to_time_t(now));
+      roll(day);
+
+      switch (result = admission(cost, priority, day.elapsed))
+      {
+        case Admission::admit:
+          m_used += cost;
+          m_calls.at(endpoint)++;
+          m_version++;
+          waiting = false;
+        break;
+
+        case Admission::reject:
+          log("Quota rejected call to endpoint " + std::to_string(endpoint) + ": " +
+              std::to_string(m_used) + " of " + std::to_string(m_limit) + " used");
+          waiting = false;
+        break;
+
+        case Admission::queue:
+        {
+          const Clock::time_point ready = now + std::chrono::seconds{wait_time(day.elapsed)};
+          if (ready > deadline)
+          {
+            log("Quota deferred call to endpoint " + std::to_string(endpoint) + " to the next pace window");
+            waiting = false;
+          }
+          else
+            m_condition.wait_until(lock, ready);
+        }
+        break;
+      }
+    }
+  }
+
+  save(false);
+  return result;
+}
+//-----------------------------------------------------------------------
+void QuotaManager::flush()
+{
+  save(true);
+}
+//-----------------------------------------------------------------------
+Admission QuotaManager::admission(const uint32_t cost, const QuotaPriority priority, const std::time_t elapsed) const
+{
+  const std::size_t index   = static_cast<std::size_t>(priority);
+  const double      ceiling = m_limit * PRIORITY_SHARE[index];
+  const double      needed  = static_cast<double>(m_used) + cost;
+
+  if (needed > ceiling)
+    return Admission::reject;
+
+  if (PRIORITY_PACED[index])
+  {
+    const double windows_left = static_cast<double>(std::max<std::time_t>(1, WINDOWS_PER_DAY - m_window));
+    const double left         = std::max(0.0, ceiling - m_window_used);
+    const double allowance    = left * std::max(PACE_HEADROOM, 1.0 / windows_left);
+    if (needed - m_window_used > allowance)
+      return Admission::queue;
+  }
+
+  return Admission::admit;
+}
+//-----------------------------------------------------------------------
+std::time_t QuotaManager::wait_time(const std::time_t elapsed) const
+{
+  return PACE_WINDOW - elapsed % PACE_WINDOW;
+}
+//-----------------------------------------------------------------------
+void QuotaManager::roll(const PacificDay& day)
+{
+  if (day.date != m_day)
+  {
+    m_day      = day.date;
+    m_used     = 0;
+    m_window   = -1;
+    m_saved_at = Clock::time_point{};
+    m_version++;
+    std::fill(m_calls.begin(), m_calls.end(), 0);
+  }
+
+  const std::time_t window = day.elapsed / PACE_WINDOW;
+  if (window != m_window)
+  {
+    m_window      = window;
+    m_window_used = m_used;
+  }
+}
+//-----------------------------------------------------------------------
+void QuotaManager::load()
+{
+  std::ifstream file{m_path};
+  std::string   day{};
+  uint32_t      used{};
+
+  if (!(file >> day >> used) || day != m_day)
+    return;
+
+  m_used = used;
+  for (auto& count : m_calls)
+    if (!(file >> count))
+      break;
+}
+//-----------------------------------------------------------------------
+void QuotaManager::save(const bool force)
+{
+  std::unique_lock<std::mutex> file_lock{m_file_mutex, std::defer_lock};
+  if (force)
+    file_lock.lock();
+  else
+  if (!file_lock.try_lock())
+    return;
+
+  Ledger ledger{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const Clock::time_point     now = Clock::now();
+    if (m_version == m_saved_version || (!force && now < m_saved_at + SAVE_INTERVAL))
+      return;
+
+    ledger          = Ledger{m_day, m_used, m_calls};
+    m_saved_version = m_version;
+    m_saved_at      = now;
+  }
+
+  write(ledger);
+}
+//-----------------------------------------------------------------------
+void QuotaManager::write(const Ledger& ledger) const
+{
+  std::ofstream file{m_path, std::ios::trunc};
+
+  if (!file)
+  {
+    log("Unable to write quota ledger to " + m_path);
+    return;
+  }
+
+  file << ledger.day << '\n' << ledger.used << '\n';
+  for (std::size_t i = 0; i < ledger.calls.size(); i++)
+    file << (i ? " " : "") << ledger.calls[i];
+  file << '\n';
+}
+//-----------------------------------------------------------------------
+uint32_t QuotaManager::used() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_used;
+}
+//-----------------------------------------------------------------------
+uint32_t QuotaManager::remaining() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return (m_used < m_limit) ? m_limit - m_used : 0;
+}
+//-----------------------------------------------------------------------
+uint32_t QuotaManager::calls(const uint8_t endpoint) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_calls.at(endpoint);
+}
+//-----------------------------------------------------------------------
+std::string QuotaManager::day() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_day;
+}
+
+} // namespace ktube
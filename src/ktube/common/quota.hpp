@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+
+namespace ktube {
+enum class QuotaPriority
+{
+  live     = 0x00,
+  reply    = 0x01,
+  standard = 0x02,
+  explore  = 0x03
+};
+//-----------------------------------------------------------------------
+enum class Admission
+{
+  admit  = 0x00,
+  queue  = 0x01,
+  reject = 0x02
+};
+//-----------------------------------------------------------------------
+struct QuotaCharge
+{
+  uint8_t       endpoint; // youtube::*_QUOTA_INDEX
+  QuotaPriority priority;
+};
+//-----------------------------------------------------------------------
+struct PacificDay
+{
+  std::string date;    // YYYY-MM-DD
+  std::time_t elapsed; // seconds since Pacific midnight
+};
+
+/**
+ * ToPacificDay
+ *
+ * YouTube resets quota at midnight Pacific time. US daylight saving rules are
+ * applied directly so no timezone database is needed.
+ *
+ * @param   [in]  {std::time_t} utc
+ * @returns [out] {PacificDay}
+ */
+PacificDay ToPacificDay(const std::time_t utc);
+
+/**
+ * QuotaManager
+ *
+ * Daily quota ledger for the Data API. Every call is charged the
+ * youtube::QUOTA_LIMIT cost of its endpoint before it is made, and usage is
+ * written to disk so a restart does not forget what the day has spent.
+ *
+ * Each priority may only spend up to its share of the daily quota, leaving the
+ * rest for higher priorities:
+ *
+ *   live     100%  chat polling and live discovery
+ *   reply     95%  chat messages and comment replies
+ *   standard  80%  videos.list, channels.list, commentThreads.list
+ *   explore   50%  search.list
+ *
+ * standard and explore calls are also paced against what their share has
+ * left. The Pacific day is split into hourly windows, and each window may
+ * spend the larger of PACE_HEADROOM or an even split over the windows left
+ * of the quota remaining when it opened. Quota an idle window did not spend
+ * is spread over the rest of the day. A call beyond its window's allowance
+ * is queued until the next window.
+ *
+ * acquire() reports a queued call as Admission::queue, distinct from a
+ * rejection, and only waits for the window when given a max_wait. Callers
+ * on their own thread wait; callers on Executor workers get the queue result
+ * back at once and hand the call to a thread that can wait.
+ *
+ * The ledger is written outside the lock, at most once per SAVE_INTERVAL,
+ * on a day roll and on destruction.
+ */
+class QuotaManager {
+public:
+using Clock = std::chrono::system_clock;
+
+static constexpr std::chrono::seconds DEFAULT_WAIT{0};
+static constexpr std::chrono::seconds MAX_WAIT{3600}; // one pace window
+static constexpr std::chrono::seconds SAVE_INTERVAL{5};
+
+explicit QuotaManager(std::string     path        = constants::YOUTUBE_QUOTA_PATH,
+                      const uint32_t  daily_limit = constants::youtube::YOUTUBE_DAILY_QUOTA);
+~QuotaManager();
+
+/**
+ * evaluate
+ *
+ * @param   [in]  {uint8_t}       endpoint youtube::*_QUOTA_INDEX
+ * @param   [in]  {QuotaPriority} priority
+ * @param   [in]  {std::time_t}   now
+ * @returns [out] {Admission}
+ */
+Admission evaluate(const uint8_t endpoint, const QuotaPriority priority, const std::time_t now);
+
+/**
+ * acquire
+ *
+ * Charges the cost of one call to endpoint. A queued call waits up to
+ * max_wait, which only callers on their own thread should pass.
+ *
+ * @param   [in]  {uint8_t}              endpoint youtube::*_QUOTA_INDEX
+ * @param   [in]  {QuotaPriority}        priority
+ * @param   [in]  {std::chrono::seconds} max_wait
+ * @returns [out] {Admission} admit once charged; queue if the call must wait
+ *                            for a later pace window and reject if the day's
+ *                            share is spent, both without charging
+ */
+Admission acquire(const uint8_t         endpoint,
+                  const QuotaPriority   priority,
+                  std::chrono::seconds  max_wait = DEFAULT_WAIT);
+
+/**
+ * flush
+ *
+ * Writes the ledger now if it changed since it was last written
+ */
+void flush();
+
+uint32_t    used()                              const;
+uint32_t    remaining()                         const;
+uint32_t    calls(const uint8_t endpoint)       const;
+std::string day()                               const;
+
+private:
+struct Ledger
+{
+std::string           day;
+uint32_t              used;
+std::vector<uint32_t> calls;
+};
+
+Admission   admission(const uint32_t cost, const QuotaPriority priority, const std::time_t elapsed) const;
+std::time_t wait_time(const std::time_t elapsed) const;
+void        roll(const PacificDay& day);
+void        load();
+void        save(const bool force);
+void        write(const Ledger& ledger) const;
+
+std::string             m_path;
+std::string             m_day;
+uint32_t                m_limit;
+uint32_t                m_used;
+std::vector<uint32_t>   m_calls;
+std::time_t             m_window;      // pace window index within the day
+uint32_t                m_window_used; // m_used when the window opened
+uint64_t                m_version;
+uint64_t                m_saved_version;
+Clock::time_point       m_saved_at;
+mutable std::mutex      m_mutex;
+std::mutex              m_file_mutex;
+std::condition_variable m_condition;
+};
+
+} // namespace ktube
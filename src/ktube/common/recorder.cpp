@@ -0,0 +1,126 @@
+#include "recorder.hpp"
+
+#include <thread>
+
+namespace ktube {
+template <typename T>
+static void WriteLE(std::ostream& stream, const T value)
+{
+  char bytes[sizeof(T)];
+  for (std::size_t i = 0; i < sizeof(T); i++)
+    bytes[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+  stream.write(bytes, sizeof(T));
+}
+//-----------------------------------------------------------------------
+template <typename T>
+static bool ReadLE(std::istream& stream, T& value)
+{
+  unsigned char bytes[sizeof(T)];
+  if (!stream.read(reinterpret_cast<char*>(bytes), sizeof(T)))
+    return false;
+
+  uint64_t result{0};
+  for (std::size_t i = 0; i < sizeof(T); i++)
+    result |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  value = static_cast<T>(result);
+  return true;
+}
+//-----------------------------------------------------------------------
+bool ChatRecorder::open(const std::string& path)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_file.close();
+  m_file.open(path, std::ios::binary | std::ios::app);
+
+  if (m_file && m_file.tellp() == 0)
+    m_file.write(MAGIC.data(), MAGIC.size());
+
+  return m_file.good();
+}
+//-----------------------------------------------------------------------
+void ChatRecorder::close()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_file.close();
+}
+//-----------------------------------------------------------------------
+bool ChatRecorder::recording() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_file.is_open();
+}
+//-----------------------------------------------------------------------
+bool ChatRecorder::append(const std::string_view chat_id, const int64_t received, const std::string_view body)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (!m_file.is_open() || chat_id.size() > UINT16_MAX)
+    return false;
+
+  WriteLE<uint32_t>(m_file, sizeof(int64_t) + sizeof(uint16_t) + chat_id.size() + body.size());
+  WriteLE<int64_t> (m_file, received);
+  WriteLE<uint16_t>(m_file, chat_id.size());
+  m_file.write(chat_id.data(), chat_id.size());
+  m_file.write(body.data(),    body.size());
+  m_file.flush();
+
+  return m_file.good();
+}
+//-----------------------------------------------------------------------
+ChatRecordReader::ChatRecordReader(const std::string& path)
+: m_file(path, std::ios::binary),
+  m_good(false)
+{
+  std::string magic(ChatRecorder::MAGIC.size(), '\0');
+  m_good = m_file.read(magic.data(), magic.size()) && magic == ChatRecorder::MAGIC;
+}
+//-----------------------------------------------------------------------
+bool ChatRecordReader::next(ChatRecord& record)
+{
+  uint32_t length{};
+  uint16_t id_length{};
+
+  if (!m_good || !ReadLE(m_file, length) || !ReadLE(m_file, record.received) || !ReadLE(m_file, id_length) ||
+      length < sizeof(int64_t) + sizeof(uint16_t) + id_length)
+    return m_good = false;
+
+  record.chat_id.resize(id_length);
+  record.body.resize(length - sizeof(int64_t) - sizeof(uint16_t) - id_length);
+
+  if (!m_file.read(record.chat_id.data(), record.chat_id.size()) ||
+      !m_file.read(record.body.data(),    record.body.size()))
+    return m_good = false;
+
+  return true;
+}
+//-----------------------------------------------------------------------
+ChatReplay::ChatReplay(std::string path, const double speed)
+: m_path(std::move(path)),
+  m_speed(speed) {}
+//-----------------------------------------------------------------------
+std::size_t ChatReplay::run(const Handler& handle) const
+{
+  using namespace std::chrono;
+
+  ChatRecordReader reader{m_path};
+  ChatRecord       record{};
+  std::size_t      count{0};
+  int64_t          first{0};
+  const auto       start = steady_clock::now();
+
+  while (reader.next(record))
+  {
+    if (!count)
+      first = record.received;
+
+    if (m_speed > 0)
+      std::this_thread::sleep_until(start + duration_cast<steady_clock::duration>(
+        duration<double, std::milli>{(record.received - first) / m_speed}));
+
+    handle(record);
+    count++;
+  }
+
+  return count;
+}
+
+} // namespace ktube
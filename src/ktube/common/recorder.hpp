@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace ktube {
+/**
+ * ChatRecord
+ *
+ * One raw liveChat/messages response as it was received
+ */
+struct ChatRecord {
+std::string chat_id;
+int64_t     received{0}; // UTC milliseconds
+std::string body;
+};
+
+/**
+ * ChatRecorder
+ *
+ * Appends raw liveChat responses to a log file so a stream can be replayed
+ * offline. After an 8 byte magic, each record is laid out as:
+ *
+ *   u32 length of the rest | i64 received | u16 chat id length | chat id | body
+ *
+ * with every integer little-endian. Appending is safe from several threads.
+ * While no file is open, append() does nothing.
+ */
+class ChatRecorder {
+public:
+static constexpr std::string_view MAGIC{"KTCHAT1\n"};
+
+ChatRecorder() = default;
+
+ChatRecorder(const ChatRecorder&)            = delete;
+ChatRecorder& operator=(const ChatRecorder&) = delete;
+
+bool open(const std::string& path);
+void close();
+bool recording() const;
+
+/**
+ * append
+ *
+ * @param   [in]  {std::string_view} chat_id
+ * @param   [in]  {int64_t}          received UTC milliseconds
+ * @param   [in]  {std::string_view} body
+ * @returns [out] {bool} false if nothing was written
+ */
+bool append(const std::string_view chat_id, const int64_t received, const std::string_view body);
+
+private:
+std::ofstream      m_file;
+mutable std::mutex m_mutex;
+};
+
+/**
+ * ChatRecordReader
+ *
+ * Reads a ChatRecorder log back. A record cut short by a crash ends the log.
+ */
+class ChatRecordReader {
+public:
+explicit ChatRecordReader(const std::string& path);
+
+bool good() const { return m_good; }
+bool next(ChatRecord& record);
+
+private:
+std::ifstream m_file;
+bool          m_good;
+};
+
+/**
+ * ChatReplay
+ *
+ * Feeds a recorded log to a handler with the original gaps between records
+ * divided by speed: 1 is real time, 100 is a hundred times faster, and 0
+ * does not wait at all.
+ */
+class ChatReplay {
+public:
+using Handler = std::function<void(const ChatRecord&)>;
+
+ChatReplay(std::string path, const double speed = 1.0);
+
+/**
+ * run
+ *
+ * @param   [in]  {Handler}     handle
+ * @returns [out] {std::size_t} number of records replayed
+ */
+std::size_t run(const Handler& handle) const;
+
+private:
+std::string m_path;
+double      m_speed;
+};
+
+/**
+ * StageLatency
+ */
+struct StageLatency {
+uint64_t                  count{0};
+std::chrono::microseconds total{0};
+std::chrono::microseconds max{0};
+
+void add(const std::chrono::steady_clock::duration duration)
+{
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration);
+  count++;
+  total += us;
+  max    = std::max(max, us);
+}
+
+std::chrono::microseconds mean() const
+{
+  return (count) ? total / static_cast<int64_t>(count) : std::chrono::microseconds{0};
+}
+};
+
+struct ReplayStats {
+uint64_t                  records{0};
+uint64_t                  messages{0};
+uint64_t                  mentions{0};
+uint64_t                  replies{0};
+std::chrono::milliseconds elapsed{0};
+StageLatency              parse;
+StageLatency              insert;
+StageLatency              tokenize;
+StageLatency              match;
+StageLatency              respond;
+
+double messages_per_second() const
+{
+  return (elapsed.count()) ? messages * 1000.0 / elapsed.count() : 0.0;
+}
+
+friend std::ostream& operator<<(std::ostream& o, const ReplayStats& s) {
+  const auto stage = [&o](const char* name, const StageLatency& l) {
+    o << "➝ " << name << l.mean().count() << "us mean, " << l.max.count() << "us max\n";
+  };
+
+  o << "➝ Records:  " << s.records  << "\n" <<
+       "➝ Messages: " << s.messages << " (" << s.messages_per_second() << "/s)\n" <<
+       "➝ Mentions: " << s.mentions << "\n" <<
+       "➝ Replies:  " << s.replies  << "\n" <<
+       "➝ Elapsed:  " << s.elapsed.count() << "ms\n";
+  stage("Parse:    ", s.parse);
+  stage("Insert:   ", s.insert);
+  stage("Tokenize: ", s.tokenize);
+  stage("Match:    ", s.match);
+  stage("Respond:  ", s.respond);
+
+  return o;
+}
+};
+
+} // namespace ktube
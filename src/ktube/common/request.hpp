@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cctype>
+#include <map>
+
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 
@@ -59,6 +62,60 @@ inline std::string GetRequestError(cpr::ErrorCode code) {
   return "UNKNOWN_ERROR";
 }
 
+using QueryParams = std::map<std::string, std::string>;
+
+/**
+ * UrlEncode
+ *
+ * Percent-encodes everything outside the RFC 3986 unreserved set
+ *
+ * @param   [in]  {std::string}
+ * @returns [out] {std::string}
+ */
+inline std::string UrlEncode(const std::string& s) {
+  static const char* HEX{"0123456789ABCDEF"};
+  std::string        encoded{};
+  encoded.reserve(s.size());
+
+  for (const char& c : s)
+  {
+    const uint8_t byte = static_cast<uint8_t>(c);
+    if (isalnum(byte) || c == '-' || c == '_' || c == '.' || c == '~')
+      encoded += c;
+    else
+    {
+      encoded += '%';
+      encoded += HEX[byte >> 4];
+      encoded += HEX[byte & 0x0F];
+    }
+  }
+
+  return encoded;
+}
+
+/**
+ * ToURL
+ *
+ * Builds the full request URL. QueryParams is ordered by name, so the same
+ * parameters always produce the same URL, which makes it usable as a cache key.
+ *
+ * @param   [in]  {std::string} url
+ * @param   [in]  {QueryParams} params
+ * @returns [out] {std::string}
+ */
+inline std::string ToURL(const std::string& url, const QueryParams& params) {
+  std::string full_url{url};
+  char        delim{'?'};
+
+  for (const auto& [name, value] : params)
+  {
+    full_url += delim + UrlEncode(name) + '=' + UrlEncode(value);
+    delim     = '&';
+  }
+
+  return full_url;
+}
+
 struct RequestResponse {
 public:
 bool          error;
@@ -66,7 +123,7 @@ cpr::Response response;
 
 RequestResponse(cpr::Response r)
 : response(r),
-  error(r.status_code >= 400)
+  error(r.status_code >= 400 || r.error.code != cpr::ErrorCode::OK)
 {}
 
 nlohmann::json json() const {
@@ -74,10 +131,37 @@ nlohmann::json json() const {
   return nlohmann::json::parse(response.text, nullptr, JSON__DO_NOT_THROW);
 }
 
-std::string text() const {
+const std::string& text() const {
   return response.text;
 }
 
+/**
+ * transient
+ *
+ * Failures worth sending again: server errors, rate limiting and transport
+ * errors where the request may never have reached the server
+ */
+bool transient() const {
+  const cpr::ErrorCode code = response.error.code;
+
+  return response.status_code >= 500                   ||
+         response.status_code == 429                   ||
+         code == cpr::ErrorCode::OPERATION_TIMEDOUT    ||
+         code == cpr::ErrorCode::CONNECTION_FAILURE    ||
+         code == cpr::ErrorCode::EMPTY_RESPONSE        ||
+         code == cpr::ErrorCode::NETWORK_RECEIVE_ERROR ||
+         code == cpr::ErrorCode::NETWORK_SEND_FAILURE;
+}
+
+bool not_modified() const {
+  return response.status_code == 304;
+}
+
+std::string etag() const {
+  const auto it = response.header.find(constants::HEADER_NAMES.at(constants::ETAG_HEADER_INDEX));
+  return (it != response.header.end()) ? it->second : "";
+}
+
 const std::string GetError() const {
   if (error) {
     std::string error_message{response.error.message};
@@ -0,0 +1,130 @@
+#include "retry.hpp"
+
+#include <condition_variable>
+#include <optional>
+
+namespace ktube {
+struct Retrier::Hedge
+{
+  std::mutex                   mutex;
+  std::condition_variable      condition;
+  std::optional<cpr::Response> response;
+  uint8_t                      pending{0};
+};
+//-----------------------------------------------------------------------
+Retrier::Retrier(const bool enabled, const std::size_t hedge_workers)
+: m_enabled(enabled),
+  m_random(std::random_device{}()),
+  m_hedges(hedge_workers) {}
+//-----------------------------------------------------------------------
+cpr::Response Retrier::run(const RetryPolicy& policy, Send send, Admit admit)
+{
+  if (!m_enabled)
+    return send();
+
+  m_budget.deposit();
+
+  for (uint8_t attempt = 1; ; attempt++)
+  {
+    cpr::Response response = (policy.hedge_after.count() > 0) ? hedged(policy, send, admit) : send();
+
+    if (!RequestResponse{response}.transient() || attempt >= policy.max_attempts || !admitted(admit))
+      return response;
+
+    std::this_thread::sleep_for(backoff(attempt, policy));
+  }
+}
+//-----------------------------------------------------------------------
+/**
+ * backoff
+ *
+ * Full jitter: a uniform delay between zero and the exponential ceiling
+ */
+std::chrono::milliseconds Retrier::backoff(const uint8_t attempt, const RetryPolicy& policy)
+{
+  const int64_t ceiling = std::min<int64_t>(policy.max_delay.count(),
+                                            policy.base_delay.count() << std::min<uint8_t>(attempt, 16));
+  std::lock_guard<std::mutex>            lock{m_mutex};
+  std::uniform_int_distribution<int64_t> distribution{0, std::max<int64_t>(ceiling, 0)};
+  return std::chrono::milliseconds{distribution(m_random)};
+}
+//-----------------------------------------------------------------------
+cpr::Response Retrier::hedged(const RetryPolicy& policy, const Send& send, const Admit& admit)
+{
+  auto hedge = std::make_shared<Hedge>();
+  launch(hedge, send);
+
+  std::unique_lock<std::mutex> lock{hedge->mutex};
+
+  if (!hedge->condition.wait_for(lock, policy.hedge_after, [&hedge] { return hedge->response.has_value(); }))
+  {
+    lock.unlock();
+    if (admitted(admit))
+      launch(hedge, send);
+    lock.lock();
+  }
+
+  hedge->condition.wait(lock, [&hedge] { return hedge->response.has_value(); });
+
+  return *hedge->response;
+}
+//-----------------------------------------------------------------------
+/**
+ * launch
+ *
+ * Sends one copy of the request on the hedge pool. The first answer that is
+ * not transient wins; a transient answer only counts once no other copy is
+ * still in flight.
+ */
+void Retrier::launch(const std::shared_ptr<Hedge>& hedge, const Send& send)
+{
+  {
+    std::lock_guard<std::mutex> lock{hedge->mutex};
+    hedge->pending++;
+  }
+
+  m_hedges.submit([hedge, send]
+  {
+    cpr::Response response = send();
+    {
+      std::lock_guard<std::mutex> lock{hedge->mutex};
+      hedge->pending--;
+
+      if (!hedge->response && (!RequestResponse{response}.transient() || hedge->pending == 0))
+        hedge->response = std::move(response);
+    }
+    hedge->condition.notify_all();
+  });
+}
+//-----------------------------------------------------------------------
+/**
+ * admitted
+ *
+ * Spends a budget token on a retry or hedge, then asks admit to charge it.
+ * The token is refunded if admit refuses, since nothing is sent.
+ */
+bool Retrier::admitted(const Admit& admit)
+{
+  if (!m_budget.withdraw())
+    return false;
+
+  if (admit && !admit())
+  {
+    m_budget.refund();
+    return false;
+  }
+
+  return true;
+}
+//-----------------------------------------------------------------------
+void Retrier::set_enabled(const bool enabled)
+{
+  m_enabled = enabled;
+}
+//-----------------------------------------------------------------------
+bool Retrier::enabled() const
+{
+  return m_enabled;
+}
+
+} // namespace ktube
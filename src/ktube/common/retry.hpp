@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "executor.hpp"
+#include "request.hpp"
+
+namespace ktube {
+/**
+ * RetryPolicy
+ *
+ * How a single endpoint wants its requests retried. Only idempotent requests
+ * should use anything other than None().
+ */
+struct RetryPolicy
+{
+  uint8_t                   max_attempts;
+  std::chrono::milliseconds base_delay;
+  std::chrono::milliseconds max_delay;
+  std::chrono::milliseconds hedge_after; // 0 never hedges
+
+  static RetryPolicy None()
+  {
+    return RetryPolicy{1, std::chrono::milliseconds{0}, std::chrono::milliseconds{0}, std::chrono::milliseconds{0}};
+  }
+
+  static RetryPolicy Backoff()
+  {
+    return RetryPolicy{4, std::chrono::milliseconds{250}, std::chrono::milliseconds{8000}, std::chrono::milliseconds{0}};
+  }
+
+  static RetryPolicy Hedged(const std::chrono::milliseconds hedge_after = std::chrono::milliseconds{750})
+  {
+    return RetryPolicy{3, std::chrono::milliseconds{100}, std::chrono::milliseconds{2000}, hedge_after};
+  }
+};
+
+/**
+ * RetryBudget
+ *
+ * Caps retries and hedges to a fraction of first attempts, so an upstream
+ * outage is not met with a multiple of the normal request rate. Each request
+ * earns `ratio` of a token and each retry or hedge spends a whole one.
+ */
+class RetryBudget {
+public:
+explicit RetryBudget(const double ratio = 0.2, const double max_tokens = 10.0)
+: m_ratio(ratio),
+  m_max_tokens(max_tokens),
+  m_tokens(max_tokens) {}
+
+void deposit()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_tokens = std::min(m_max_tokens, m_tokens + m_ratio);
+}
+
+bool withdraw()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (m_tokens < 1.0)
+    return false;
+  m_tokens -= 1.0;
+  return true;
+}
+
+void refund()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_tokens = std::min(m_max_tokens, m_tokens + 1.0);
+}
+
+private:
+double     m_ratio;
+double     m_max_tokens;
+double     m_tokens;
+std::mutex m_mutex;
+};
+
+/**
+ * Retrier
+ *
+ * Sends a request under a RetryPolicy. Transient failures (see
+ * RequestResponse::transient) are retried after a jittered exponential
+ * backoff. With a hedge delay, a duplicate request is sent if the first has
+ * not answered in time, and whichever answers first is used. Both copies of
+ * a hedged request run on a small pool owned by the Retrier, so a copy that
+ * stalls holds a pool worker until the session's timeout ends it.
+ *
+ * Every retry and hedge is a real request, so each one must first be
+ * admitted by the caller's Admit, which charges its quota. One that is not
+ * admitted is not sent, and gets its retry budget token back.
+ *
+ * When disabled, every request is sent exactly once.
+ */
+class Retrier {
+public:
+using Send  = std::function<cpr::Response()>;
+using Admit = std::function<bool()>;
+
+static constexpr std::size_t HEDGE_WORKERS{8};
+
+explicit Retrier(const bool enabled = false, const std::size_t hedge_workers = HEDGE_WORKERS);
+
+Retrier(const Retrier&)            = delete;
+Retrier& operator=(const Retrier&) = delete;
+
+/**
+ * run
+ *
+ * @param   [in]  {RetryPolicy}   policy
+ * @param   [in]  {Send}          send   Must be safe to call from another thread
+ * @param   [in]  {Admit}         admit  Asked before each retry or hedge, none admits all
+ * @returns [out] {cpr::Response}
+ */
+cpr::Response             run(const RetryPolicy& policy, Send send, Admit admit = nullptr);
+std::chrono::milliseconds backoff(const uint8_t attempt, const RetryPolicy& policy);
+void                      set_enabled(const bool enabled);
+bool                      enabled() const;
+
+private:
+struct Hedge;
+
+cpr::Response hedged(const RetryPolicy& policy, const Send& send, const Admit& admit);
+void          launch(const std::shared_ptr<Hedge>& hedge, const Send& send);
+bool          admitted(const Admit& admit);
+
+std::atomic<bool> m_enabled;
+RetryBudget       m_budget;
+std::mt19937      m_random;
+std::mutex        m_mutex;
+Executor          m_hedges; // last, so it is drained before the rest goes away
+};
+
+} // namespace ktube
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "decoder.hpp"
+
+namespace ktube {
+namespace schema {
+constexpr std::size_t MAX_DEPTH{6};
+
+/**
+ * Path
+ *
+ * A dotted key path such as "snippet.thumbnails.high.url", split into its
+ * keys at compile time.
+ */
+struct Path {
+std::array<std::string_view, MAX_DEPTH> keys{};
+std::size_t                             size{0};
+
+constexpr Path(std::string_view dotted)
+{
+  while (size < MAX_DEPTH)
+  {
+    const std::size_t dot = dotted.find('.');
+    keys[size++] = dotted.substr(0, dot);
+    if (dot == std::string_view::npos)
+      break;
+    dotted.remove_prefix(dot + 1);
+  }
+}
+};
+
+/**
+ * Field
+ *
+ * Binds a path, relative to the object being decoded, to a member. Several
+ * member pointers reach into nested members:
+ *
+ *   Field<&ChannelInfo::stats, &ChannelStats::views>{"statistics.viewCount"}
+ *
+ * A std::vector<std::string> member collects an array of strings. A vector
+ * of the envelope's Item type collects its objects, each decoded with
+ * Schema<Item>.
+ */
+template <auto Member, auto... Members>
+struct Field {
+Path path;
+
+constexpr Field(const std::string_view dotted) : path(dotted) {}
+
+template <typename T>
+static auto& get(T& object) { return ((object.*Member) .* ... .* Members); }
+};
+
+/**
+ * Keyed
+ *
+ * An item whose id is not part of T, such as the key of a VideoStatsMap
+ */
+template <typename T>
+struct Keyed {
+std::string key;
+T           value;
+};
+
+/**
+ * Defaults
+ *
+ * finish() runs on each decoded item. Returning false drops the item.
+ */
+struct Defaults {
+template <typename T>
+static bool finish(T&) { return true; }
+};
+} // namespace schema
+
+/**
+ * Schema
+ *
+ * Specialized for every decoded type with a constexpr tuple of Fields.
+ * Envelopes, the top level object of a response, also name the Item type
+ * of their items array.
+ */
+template <typename T>
+struct Schema;
+
+template <typename T>
+struct Schema<Page<T>> : schema::Defaults {
+using Item = T;
+static constexpr auto fields = std::make_tuple(
+  schema::Field<&Page<T>::next_page_token>{"nextPageToken"},
+  schema::Field<&Page<T>::items>          {"items"}
+);
+};
+
+/**
+ * SchemaDecoder
+ *
+ * The decoder generated from Schema<T> and Schema<Item>. Each open container
+ * keeps a bitmask of the fields whose path still matches, so every key is
+ * compared once against the few fields that can still want it, and a
+ * container no field wants is skipped whole. Values that are missing or of
+ * an unexpected type leave the member at its default.
+ */
+template <typename T, typename Item = typename Schema<T>::Item>
+class SchemaDecoder : public SaxDecoder {
+public:
+SchemaDecoder()
+: m_levels{Level{Scope::envelope, 0, All<T>()}} {}
+
+T take() { return std::move(m_result); }
+
+protected:
+bool enter(const std::string_view key) override
+{
+  const Level top = m_levels.back();
+  switch (top.scope)
+  {
+    case Scope::items:
+      m_item = Item{};
+      m_levels.emplace_back(Level{Scope::item, 0, All<Item>()});
+    return true;
+    case Scope::strings:
+    return false;
+    case Scope::item:
+    return descend<Item>(top, key);
+    default:
+    return descend<T>(top, key);
+  }
+}
+
+void leave() override
+{
+  const Level level = m_levels.back();
+  m_levels.pop_back();
+
+  if (level.scope == Scope::item && !level.depth && Schema<Item>::finish(m_item))
+    ForEach(Schema<T>::fields, [this](const auto& field, const uint32_t bit) {
+      if constexpr (std::is_same_v<Member<decltype(field), T>, std::vector<Item>>)
+        if (m_levels.back().fields & bit)
+          field.get(m_result).emplace_back(std::move(m_item));
+    });
+}
+
+void value(const std::string_view key, std::string& text) override
+{
+  assign(key, text);
+}
+
+void value(const std::string_view key, const uint64_t number) override
+{
+  assign(key, number);
+}
+
+private:
+enum class Scope : uint8_t {
+  envelope, // fields of T
+  items,    // the array of Items
+  item,     // fields of Item
+  strings   // a std::vector<std::string> field
+};
+
+struct Level {
+Scope    scope;
+uint8_t  depth;  // keys matched so far within the scope
+uint32_t fields; // bit per field whose path still matches
+};
+
+template <typename F, typename Owner>
+using Member = std::remove_reference_t<decltype(std::decay_t<F>::get(std::declval<Owner&>()))>;
+
+template <typename Tuple, typename F>
+static void ForEach(const Tuple& fields, F&& f)
+{
+  std::apply([&f](const auto&... field) {
+    uint32_t bit{1};
+    ((f(field, bit), bit <<= 1), ...);
+  }, fields);
+}
+
+template <typename U>
+static constexpr uint32_t All()
+{
+  constexpr std::size_t size = std::tuple_size_v<std::decay_t<decltype(Schema<U>::fields)>>;
+  static_assert(size <= 32, "A schema has at most 32 fields");
+  return (size == 32) ? UINT32_MAX : (uint32_t{1} << size) - 1;
+}
+
+template <typename Owner>
+bool descend(const Level& top, const std::string_view key)
+{
+  uint32_t next{0};
+  Scope    scope{Scope::envelope};
+
+  ForEach(Schema<Owner>::fields, [&](const auto& field, const uint32_t bit) {
+    const schema::Path& path = field.path;
+    if (!(top.fields & bit) || path.size <= top.depth || path.keys[top.depth] != key)
+      return;
+
+    using M = Member<decltype(field), Owner>;
+    if (path.size > top.depth + 1u)
+      next |= bit;
+    else
+    if constexpr (std::is_same_v<M, std::vector<std::string>>)
+      next = bit, scope = Scope::strings;
+    else
+    if constexpr (std::is_same_v<Owner, T> && std::is_same_v<M, std::vector<Item>>)
+      next = bit, scope = Scope::items;
+  });
+
+  if (!next)
+    return false;
+
+  if (scope == Scope::envelope)
+    scope = top.scope;
+
+  m_levels.emplace_back(Level{scope, static_cast<uint8_t>(top.depth + 1), next});
+  return true;
+}
+
+template <typename V>
+void assign(const std::string_view key, V& value)
+{
+  const Level& top = m_levels.back();
+  if (top.scope == Scope::strings)
+  {
+    if constexpr (std::is_same_v<V, std::string>)
+    {
+      if (m_levels[m_levels.size() - 2].scope == Scope::item)
+        append(Schema<Item>::fields, m_item, top.fields, value);
+      else
+        append(Schema<T>::fields, m_result, top.fields, value);
+    }
+  }
+  else
+  if (top.scope == Scope::item)
+    assign(Schema<Item>::fields, m_item, top, key, value);
+  else
+  if (top.scope == Scope::envelope)
+    assign(Schema<T>::fields, m_result, top, key, value);
+}
+
+template <typename Fields, typename Owner, typename V>
+static void assign(const Fields& fields, Owner& owner, const Level& top, const std::string_view key, V& value)
+{
+  ForEach(fields, [&](const auto& field, const uint32_t bit) {
+    const schema::Path& path = field.path;
+    if ((top.fields & bit) && path.size == top.depth + 1u && path.keys[top.depth] == key)
+      Assign(field.get(owner), value);
+  });
+}
+
+template <typename Fields, typename Owner>
+static void append(const Fields& fields, Owner& owner, const uint32_t field_bit, std::string& text)
+{
+  ForEach(fields, [&](const auto& field, const uint32_t bit) {
+    if constexpr (std::is_same_v<Member<decltype(field), Owner>, std::vector<std::string>>)
+      if (field_bit == bit)
+        field.get(owner).emplace_back(std::move(text));
+  });
+}
+
+template <typename M, typename V>
+static void Assign(M& member, V& value)
+{
+  if constexpr (std::is_same_v<M, std::string> && std::is_same_v<V, std::string>)
+    member = std::move(value);
+  else
+  if constexpr (std::is_integral_v<M> && std::is_same_v<V, std::string>)
+    member = static_cast<M>(ParseCount(value));
+  else
+  if constexpr (std::is_integral_v<M> && std::is_same_v<V, const uint64_t>)
+    member = static_cast<M>(value);
+  else
+  if constexpr (std::is_same_v<M, std::chrono::milliseconds> && std::is_same_v<V, const uint64_t>)
+    member = std::chrono::milliseconds{value};
+}
+
+std::vector<Level> m_levels;
+T                  m_result{};
+Item               m_item{};
+};
+
+/**
+ * Decode
+ *
+ * @param   [in]  {std::string_view} text
+ * @returns [out] {T} empty if text is not valid JSON
+ */
+template <typename T>
+T Decode(const std::string_view text)
+{
+  SchemaDecoder<T> decoder{};
+  return (decoder.decode(text)) ? decoder.take() : T{};
+}
+
+} // namespace ktube
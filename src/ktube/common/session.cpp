@@ -0,0 +1,195 @@
+#include "session.hpp"
+
+#include <zlib.h>
+
+#include "constants.hpp"
+
+namespace ktube {
+static bool IsGzip(const cpr::Header& header)
+{
+  using namespace constants;
+
+  const auto it = header.find(HEADER_NAMES.at(CONTENT_ENCODING_INDEX));
+  return it != header.end() && it->second == HEADER_VALUES.at(GZIP_INDEX);
+}
+//-----------------------------------------------------------------------
+static bool Gunzip(const std::string& data, std::string& output)
+{
+  const std::size_t CHUNK_SIZE{16384};
+  z_stream          stream{};
+  char              buffer[CHUNK_SIZE];
+  int               result;
+
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+    return false;
+
+  stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  output.clear();
+  output.reserve(data.size() * 4);
+
+  do
+  {
+    stream.next_out  = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = CHUNK_SIZE;
+    result           = inflate(&stream, Z_NO_FLUSH);
+
+    if (result != Z_OK && result != Z_STREAM_END)
+      break;
+
+    output.append(buffer, CHUNK_SIZE - stream.avail_out);
+  }
+  while (result != Z_STREAM_END);
+
+  inflateEnd(&stream);
+
+  return result == Z_STREAM_END;
+}
+//-----------------------------------------------------------------------
+SessionPool::Lease::Lease(SessionPool& pool, std::unique_ptr<cpr::Session> session)
+: m_pool(&pool),
+  m_session(std::move(session)) {}
+//-----------------------------------------------------------------------
+SessionPool::Lease::Lease(Lease&& other) noexcept
+: m_pool(other.m_pool),
+  m_session(std::move(other.m_session)) {}
+//-----------------------------------------------------------------------
+SessionPool::Lease::~Lease()
+{
+  if (m_session)
+    m_pool->release(std::move(m_session));
+}
+//-----------------------------------------------------------------------
+cpr::Session& SessionPool::Lease::operator*()
+{
+  return *m_session;
+}
+//-----------------------------------------------------------------------
+cpr::Session* SessionPool::Lease::operator->()
+{
+  return m_session.get();
+}
+//-----------------------------------------------------------------------
+SessionPool::SessionPool(const std::size_t size)
+: m_size(size ? size : 1),
+  m_created(0),
+  m_compress(true)
+{
+  m_idle.reserve(m_size);
+}
+//-----------------------------------------------------------------------
+SessionPool::Lease SessionPool::acquire()
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  if (m_idle.empty() && m_created < m_size)
+  {
+    m_created++;
+    auto session = std::make_unique<cpr::Session>();
+    session->SetTimeout(cpr::Timeout{REQUEST_TIMEOUT});
+    return Lease{*this, std::move(session)};
+  }
+
+  m_condition.wait(lock, [this] { return !m_idle.empty(); });
+
+  std::unique_ptr<cpr::Session> session = std::move(m_idle.back());
+  m_idle.pop_back();
+
+  return Lease{*this, std::move(session)};
+}
+//-----------------------------------------------------------------------
+void SessionPool::release(std::unique_ptr<cpr::Session> session)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_idle.emplace_back(std::move(session));
+  }
+  m_condition.notify_one();
+}
+//-----------------------------------------------------------------------
+cpr::Response SessionPool::Get(const cpr::Url&        url,
+                               const cpr::Header&     header,
+                               const cpr::Parameters& params,
+                               const cpr::VerifySsl&  verify_ssl)
+{
+  Lease session = acquire();
+  session->SetUrl(url);
+  session->SetHeader(with_encoding(header));
+  session->SetParameters(params);
+  session->SetVerifySsl(verify_ssl);
+
+  return decoded(session->Get());
+}
+//-----------------------------------------------------------------------
+cpr::Response SessionPool::Post(const cpr::Url&        url,
+                                const cpr::Header&     header,
+                                const cpr::Parameters& params,
+                                const cpr::Body&       body,
+                                const cpr::VerifySsl&  verify_ssl)
+{
+  Lease session = acquire();
+  session->SetUrl(url);
+  session->SetHeader(with_encoding(header));
+  session->SetParameters(params);
+  session->SetBody(body);
+  session->SetVerifySsl(verify_ssl);
+
+  return decoded(session->Post());
+}
+//-----------------------------------------------------------------------
+cpr::Response SessionPool::Post(const cpr::Url&       url,
+                                const cpr::Header&    header,
+                                const cpr::Body&      body,
+                                const cpr::VerifySsl& verify_ssl)
+{
+  return Post(url, header, cpr::Parameters{}, body, verify_ssl);
+}
+//-----------------------------------------------------------------------
+cpr::Header SessionPool::with_encoding(cpr::Header header) const
+{
+  using namespace constants;
+
+  if (m_compress)
+  {
+    header.emplace(HEADER_NAMES.at(ACCEPT_ENCODING_INDEX), HEADER_VALUES.at(GZIP_INDEX));
+    header.emplace(HEADER_NAMES.at(USER_AGENT_INDEX),      HEADER_VALUES.at(GZIP_USER_AGENT_INDEX));
+  }
+
+  return header;
+}
+//-----------------------------------------------------------------------
+/**
+ * decoded
+ *
+ * Inflates a body the server says is gzip encoded. A body that does not
+ * inflate is dropped and the response carries an error instead.
+ */
+cpr::Response SessionPool::decoded(cpr::Response response) const
+{
+  if (!IsGzip(response.header))
+    return response;
+
+  std::string inflated{};
+  if (Gunzip(response.text, inflated))
+    response.text = std::move(inflated);
+  else
+  {
+    response.text.clear();
+    response.error.code    = cpr::ErrorCode::INTERNAL_ERROR;
+    response.error.message = "Failed to inflate gzip response body";
+  }
+
+  return response;
+}
+//-----------------------------------------------------------------------
+std::size_t SessionPool::size() const
+{
+  return m_size;
+}
+//-----------------------------------------------------------------------
+void SessionPool::set_compression(const bool compress)
+{
+  m_compress = compress;
+}
+
+} // namespace ktube
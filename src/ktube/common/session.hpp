@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cpr/cpr.h>
+
+namespace ktube {
+/**
+ * SessionPool
+ *
+ * Owns a fixed set of persistent cpr::Session handles. Every session keeps its
+ * curl handle (and with it the open connection and TLS state) alive between
+ * calls, so requests to googleapis.com are not paying a handshake each time.
+ *
+ * Sessions are handed out as leases: a caller holds exclusive use of one
+ * session until the lease is destroyed. When every session is leased, the
+ * next caller waits for one to be returned. Every session gives up on a
+ * request after REQUEST_TIMEOUT, so a stalled upstream cannot hold a lease
+ * for good.
+ *
+ * Compressed transfer is requested by default. Google only serves gzip to
+ * clients whose user agent mentions it, so both headers are sent. A body the
+ * server marks with Content-Encoding: gzip is inflated before the response is
+ * returned, and one that fails to inflate comes back as an error.
+ */
+class SessionPool {
+public:
+static constexpr std::size_t               DEFAULT_SIZE{4};
+static constexpr std::chrono::milliseconds REQUEST_TIMEOUT{30000};
+
+class Lease {
+public:
+Lease(SessionPool& pool, std::unique_ptr<cpr::Session> session);
+Lease(Lease&& other) noexcept;
+Lease(const Lease&)            = delete;
+Lease& operator=(const Lease&) = delete;
+~Lease();
+
+cpr::Session& operator*();
+cpr::Session* operator->();
+
+private:
+SessionPool*                  m_pool;
+std::unique_ptr<cpr::Session> m_session;
+};
+
+explicit SessionPool(const std::size_t size = DEFAULT_SIZE);
+
+Lease         acquire();
+cpr::Response Get (const cpr::Url&        url,
+                   const cpr::Header&     header,
+                   const cpr::Parameters& params,
+                   const cpr::VerifySsl&  verify_ssl = cpr::VerifySsl{true});
+cpr::Response Post(const cpr::Url&        url,
+                   const cpr::Header&     header,
+                   const cpr::Parameters& params,
+                   const cpr::Body&       body,
+                   const cpr::VerifySsl&  verify_ssl = cpr::VerifySsl{true});
+cpr::Response Post(const cpr::Url&        url,
+                   const cpr::Header&     header,
+                   const cpr::Body&       body,
+                   const cpr::VerifySsl&  verify_ssl = cpr::VerifySsl{true});
+std::size_t   size() const;
+void          set_compression(const bool compress);
+
+private:
+void          release(std::unique_ptr<cpr::Session> session);
+cpr::Header   with_encoding(cpr::Header header) const;
+cpr::Response decoded(cpr::Response response) const;
+
+std::vector<std::unique_ptr<cpr::Session>> m_idle;
+std::size_t                                m_size;
+std::size_t                                m_created;
+std::atomic<bool>                          m_compress;
+std::mutex                                 m_mutex;
+std::condition_variable                    m_condition;
+};
+
+} // namespace ktube
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chat_buffer.hpp"
+#include "executor.hpp"
+
+namespace ktube {
+/**
+ * TokenizeMessages
+ *
+ * Pipeline stage that tokenizes the messages that arrived in a chat since
+ * `since`. Messages already marked tokenized are skipped, so each message is
+ * tokenized once however often the stage runs. The texts are copied out
+ * under the buffer lock and tokenized on the executor. The results are then
+ * written back in arrival order and each message is marked tokenized. A
+ * message the buffer dropped in the meantime is simply not written back.
+ *
+ * @param   [in]  {ChatBuffer}         chat
+ * @param   [in]  {ChatBuffer::Cursor} since
+ * @param   [in]  {Executor}           executor
+ * @param   [in]  {F}                  tokenize std::vector<Token>(const std::string&)
+ * @returns [out] {ChatBuffer::Cursor} cursor for the next run
+ */
+template <typename F>
+ChatBuffer::Cursor TokenizeMessages(ChatBuffer& chat, const ChatBuffer::Cursor since, Executor& executor, F&& tokenize)
+{
+  using Pending = std::pair<ChatBuffer::Cursor, std::string>;
+
+  std::vector<Pending>     pending{};
+  const ChatBuffer::Cursor end = chat.read(since, [&pending](ChatBuffer::Cursor seq, const LiveMessage& message) {
+    if (!message.tokenized)
+      pending.emplace_back(seq, message.text);
+  });
+
+  if (pending.empty())
+    return end;
+
+  std::vector<std::vector<Token>> tokens = executor.map(pending, [&tokenize](const Pending& message) {
+    return tokenize(message.second);
+  });
+
+  for (std::size_t i = 0; i < pending.size(); i++)
+    chat.at(pending[i].first, [&tokens, i](LiveMessage& message) {
+      message.tokens    = std::move(tokens[i]);
+      message.tokenized = true;
+    });
+
+  return end;
+}
+
+} // namespace ktube
@@ -92,10 +92,10 @@ struct TermInfo {
 
 
 struct VideoStats {
-std::string              views;
-std::string              likes;
-std::string              dislikes;
-std::string              comments;
+uint64_t                 views{0};
+uint64_t                 likes{0};
+uint64_t                 dislikes{0};
+uint64_t                 comments{0};
 std::vector<std::string> keywords;
 double                   view_score;
 double                   like_score;
@@ -173,9 +173,9 @@ friend std::ostream &operator<<(std::ostream& o, const Video& v) {
 }; // struct VideoInfo
 
 struct ChannelStats {
-std::string views;
-std::string subscribers;
-std::string videos;
+uint64_t views{0};
+uint64_t subscribers{0};
+uint64_t videos{0};
 };
 
 struct ChannelInfo {
@@ -218,18 +218,13 @@ struct VideoDetails {
 };
 
 struct LiveMessage {
+  std::string        id;
   std::string        timestamp;
+  int64_t            published{0}; // UTC milliseconds
   std::string        author;
   std::string        text;
   std::vector<Token> tokens;
-};
-
-struct UserInteraction {
-  std::string id;
-  bool        greeted;
-  bool        promoted;
-  bool        probed;
-  bool        location;
+  bool               tokenized{false};
 };
 
 enum Interaction {
@@ -239,12 +234,10 @@ enum Interaction {
   location_ask  = 0x03
 };
 
+using VideoStatsMap  = std::unordered_map<std::string, VideoStats>;
+using ChannelInfoMap = std::unordered_map<std::string, ChannelInfo>;
 using LiveMessages = std::vector<LiveMessage>;
 using Chat         = std::pair<std::string, LiveMessages>;
 using LiveChatMap  = std::map<std::string, LiveMessages>;
-using ActivityMap  = std::map<std::string, UserInteraction>;
-using LocationMap  = std::map<std::string, bool>;
-using PersonMap    = LocationMap;
-using OrgMap       = LocationMap;
 
 }
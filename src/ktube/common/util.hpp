@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <ctime>
 #include <cstdlib>
 #include <iomanip>
@@ -9,6 +11,9 @@
 #include <ostream>
 #include <fstream>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <functional>
 #include <type_traits>
 
 #include <kjson.hpp>
@@ -151,66 +156,298 @@ inline std::string CreateStringWithBreaks(const std::string &in, const size_t ev
   return out;
 }
 
+/**
+ * days_from_civil
+ *
+ * @param   [in]  {int64_t}  year
+ * @param   [in]  {unsigned} month 1-12
+ * @param   [in]  {unsigned} day   1-31
+ * @returns [out] {int64_t}  days since 1970-01-01
+ */
+inline constexpr int64_t days_from_civil(int64_t year, const unsigned month, const unsigned day) {
+  year -= month <= 2;
+  const int64_t  era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(year - era * 400);
+  const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+/**
+ * civil_from_days
+ *
+ * The inverse of days_from_civil
+ *
+ * @param [in]  {int64_t}  days since 1970-01-01
+ * @param [out] {int64_t}  year
+ * @param [out] {unsigned} month 1-12
+ * @param [out] {unsigned} day   1-31
+ */
+inline constexpr void civil_from_days(int64_t days, int64_t& year, unsigned& month, unsigned& day) {
+  days += 719468;
+  const int64_t  era = (days >= 0 ? days : days - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(days - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp  = (5 * doy + 2) / 153;
+  day   = doy - (153 * mp + 2) / 5 + 1;
+  month = (mp < 10) ? mp + 3 : mp - 9;
+  year  = static_cast<int64_t>(yoe) + era * 400 + (month <= 2);
+}
+
+/**
+ * parse_datetime
+ *
+ * Reads an RFC 3339 timestamp, such as 2021-02-05T19:06:47.258Z or
+ * 2021-02-05T11:06:47-08:00, as UTC milliseconds. The date and time sit at
+ * fixed offsets, so each field is read in place with no stream, locale or
+ * timezone lookup. A fraction past milliseconds is truncated.
+ *
+ * @param   [in]  {std::string_view} datetime
+ * @param   [out] {int64_t}          ms
+ * @returns [out] {bool}             false if datetime is not a timestamp
+ */
+inline bool parse_datetime(const std::string_view datetime, int64_t& ms) {
+  if (datetime.size() < 19 || datetime[4]  != '-' || datetime[7]  != '-' ||
+      datetime[13] != ':'   || datetime[16] != ':' ||
+      (datetime[10] != 'T'  && datetime[10] != 't' && datetime[10] != ' '))
+    return false;
+
+  uint32_t invalid{0};
+  const auto digits = [&datetime, &invalid](std::size_t pos, const std::size_t count) {
+    int64_t value{0};
+    for (const std::size_t end = pos + count; pos < end; pos++)
+    {
+      const uint32_t digit = static_cast<uint8_t>(datetime[pos]) - uint32_t{'0'};
+      invalid |= (digit > 9);
+      value    = value * 10 + digit;
+    }
+    return value;
+  };
+
+  const int64_t year   = digits(0,  4);
+  const int64_t month  = digits(5,  2);
+  const int64_t day    = digits(8,  2);
+  const int64_t hour   = digits(11, 2);
+  const int64_t minute = digits(14, 2);
+  const int64_t second = digits(17, 2);
+
+  if (invalid || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    return false;
+
+  std::size_t pos = 19;
+  int64_t     fraction{0};
+
+  if (pos < datetime.size() && datetime[pos] == '.')
+  {
+    int64_t scale{100};
+    for (pos++; pos < datetime.size() && isdigit(static_cast<uint8_t>(datetime[pos])); pos++, scale /= 10)
+      fraction += (datetime[pos] - '0') * scale;
+  }
+
+  int64_t offset_minutes{0};
+  if (pos + 6 <= datetime.size() && (datetime[pos] == '+' || datetime[pos] == '-') && datetime[pos + 3] == ':')
+  {
+    const int64_t offset = digits(pos + 1, 2) * 60 + digits(pos + 4, 2);
+    if (!invalid)
+      offset_minutes = (datetime[pos] == '-' ? -1 : 1) * offset;
+  }
+
+  const int64_t days = days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+
+  ms = ((days * 24 + hour) * 60 + minute - offset_minutes) * 60000 + second * 1000 + fraction;
+  return true;
+}
+
+/**
+ * to_epoch_ms
+ *
+ * @param   [in]  {std::string_view} datetime RFC 3339
+ * @returns [out] {int64_t}          UTC milliseconds, 0 if datetime is not a timestamp
+ */
+inline int64_t to_epoch_ms(const std::string_view datetime) {
+  int64_t ms{0};
+  return (parse_datetime(datetime, ms)) ? ms : 0;
+}
+
 /**
  * to_unixtime
  *
- * @param
- * @returns
+ * @param   [in]  {std::string_view} datetime RFC 3339
+ * @returns [out] {std::time_t}      UTC seconds, 0 if datetime is not a timestamp
  */
-inline const std::time_t to_unixtime(const char* datetime) {
-  std::tm            t{};
-  std::istringstream ss{datetime};
+inline std::time_t to_unixtime(const std::string_view datetime) {
+  return static_cast<std::time_t>(to_epoch_ms(datetime) / 1000);
+}
 
-  ss >> std::get_time(&t, "%Y-%m-%dT%H:%M:%S");
+/**
+ * TimestampCache
+ *
+ * Remembers the UTC milliseconds of recently parsed timestamps, one per slot
+ * of a small direct-mapped table. A hit is a hash and a compare. Slot keys
+ * keep their capacity, so a warm cache does not allocate.
+ */
+class TimestampCache {
+public:
+static constexpr std::size_t SLOTS{64};
 
-  return mktime(&t);
+/**
+ * get
+ *
+ * @param   [in]  {std::string_view} datetime RFC 3339
+ * @returns [out] {int64_t}          UTC milliseconds, 0 if datetime is not a timestamp
+ */
+int64_t get(const std::string_view datetime)
+{
+  Slot& slot = m_slots[std::hash<std::string_view>{}(datetime) % SLOTS];
+  if (slot.used && slot.datetime == datetime)
+    return slot.ms;
+
+  slot.datetime.assign(datetime.data(), datetime.size());
+  slot.ms   = to_epoch_ms(datetime);
+  slot.used = true;
+  return slot.ms;
 }
 
+private:
+struct Slot {
+std::string datetime;
+int64_t     ms{0};
+bool        used{false};
+};
+
+std::array<Slot, SLOTS> m_slots{};
+};
+
+namespace constants {
+static constexpr std::size_t DATETIME_BUFFER_SIZE{24};
+static constexpr const char* MONTH_NAMES[]{
+  "January", "February", "March",     "April",   "May",      "June",
+  "July",    "August",   "September", "October", "November", "December"
+};
+} // namespace constants
+
 /**
- * to_readable_time
+ * split_epoch_ms
  *
- * @param
- * @returns
+ * @param [in]  {int64_t} ms UTC milliseconds
+ * @param [out] {int64_t} days since 1970-01-01
+ * @param [out] {int64_t} seconds into the day
  */
-inline std::string to_readable_time(const char* datetime) {
-  uint8_t            buffer_size{24};
-  std::tm            t{};
-  std::istringstream ss{datetime};
-  char               b[buffer_size];
-  ss >> std::get_time(&t, "%Y-%m-%dT%H:%M:%S");
+inline void split_epoch_ms(const int64_t ms, int64_t& days, int64_t& seconds) {
+  int64_t total = ms / 1000;
+  if (ms % 1000 < 0)
+    total--;
+
+  days    = total / 86400;
+  seconds = total % 86400;
+  if (seconds < 0)
+  {
+    days--;
+    seconds += 86400;
+  }
+}
 
-  strftime(b, buffer_size, "%B %d %H:%M:%S", &t);
+/**
+ * write_digits
+ *
+ * Writes value as exactly count decimal digits
+ */
+inline char* write_digits(char* out, uint64_t value, const std::size_t count) {
+  for (std::size_t i = count; i > 0; i--)
+  {
+    out[i - 1] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return out + count;
+}
 
-  return std::string{b};
+/**
+ * format_datetime
+ *
+ * Writes ms as "%Y-%m-%dT%H:%M:%S" (UTC) and a terminating null.
+ *
+ * @param   [in]  {int64_t}     ms     UTC milliseconds
+ * @param   [in]  {char*}       buffer at least DATETIME_BUFFER_SIZE
+ * @returns [out] {std::size_t} characters written, not counting the null
+ */
+inline std::size_t format_datetime(const int64_t ms, char* buffer) {
+  int64_t  days, seconds, year;
+  unsigned month, day;
+  split_epoch_ms(ms, days, seconds);
+  civil_from_days(days, year, month, day);
+
+  char* out = buffer;
+  out    = write_digits(out, static_cast<uint64_t>(year) % 10000, 4);
+  *out++ = '-';
+  out    = write_digits(out, month, 2);
+  *out++ = '-';
+  out    = write_digits(out, day, 2);
+  *out++ = 'T';
+  out    = write_digits(out, seconds / 3600, 2);
+  *out++ = ':';
+  out    = write_digits(out, seconds / 60 % 60, 2);
+  *out++ = ':';
+  out    = write_digits(out, seconds % 60, 2);
+  *out   = '\0';
+
+  return static_cast<std::size_t>(out - buffer);
 }
 
 /**
- * to_readable_time
+ * format_readable_time
  *
- * @param
- * @returns
+ * Writes ms as "%B %d %H:%M:%S" (UTC, English month names) and a
+ * terminating null.
+ *
+ * @param   [in]  {int64_t}     ms     UTC milliseconds
+ * @param   [in]  {char*}       buffer at least DATETIME_BUFFER_SIZE
+ * @returns [out] {std::size_t} characters written, not counting the null
  */
-inline std::string to_readable_time(const std::string datetime) {
-  uint8_t            buffer_size{24};
-  std::tm            t{};
-  std::istringstream ss{datetime};
-  char               b[buffer_size];
-  ss >> std::get_time(&t, "%Y-%m-%dT%H:%M:%S");
+inline std::size_t format_readable_time(const int64_t ms, char* buffer) {
+  int64_t  days, seconds, year;
+  unsigned month, day;
+  split_epoch_ms(ms, days, seconds);
+  civil_from_days(days, year, month, day);
+
+  const std::string_view name{constants::MONTH_NAMES[month - 1]};
+
+  char* out = buffer;
+  out    = std::copy(name.begin(), name.end(), out);
+  *out++ = ' ';
+  out    = write_digits(out, day, 2);
+  *out++ = ' ';
+  out    = write_digits(out, seconds / 3600, 2);
+  *out++ = ':';
+  out    = write_digits(out, seconds / 60 % 60, 2);
+  *out++ = ':';
+  out    = write_digits(out, seconds % 60, 2);
+  *out   = '\0';
+
+  return static_cast<std::size_t>(out - buffer);
+}
 
-  strftime(b, buffer_size, "%B %d %H:%M:%S", &t);
+/**
+ * to_readable_time
+ *
+ * @param   [in]  {std::string_view} datetime RFC 3339
+ * @returns [out] {std::string}      "%B %d %H:%M:%S" in UTC, empty if datetime is not a timestamp
+ */
+inline std::string to_readable_time(const std::string_view datetime) {
+  int64_t ms;
+  if (!parse_datetime(datetime, ms))
+    return std::string{};
 
-  return std::string{b};
+  char b[constants::DATETIME_BUFFER_SIZE];
+  return std::string{b, format_readable_time(ms, b)};
 }
 
 inline std::string get_simple_datetime() {
-  uint8_t            buffer_size{24};
-  char               b[buffer_size];
-  auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-  struct tm tm{};
-  if (::gmtime_r(&now, &tm))
-    if (std::strftime(b, sizeof(b), constants::SIMPLE_DATE_FORMAT, &tm))
-      return std::string{b};
-  throw std::runtime_error{"Failed to get current date as string"};
+  const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+
+  char b[constants::DATETIME_BUFFER_SIZE];
+  return std::string{b, format_datetime(now, b)};
 }
 
 // template <typename T = float>
@@ -247,27 +484,23 @@ inline std::string delta_to_string(std::chrono::duration<int64_t, std::nano> d)
   return human_readable_duration(std::chrono::duration_cast<std::chrono::seconds>(d));
 }
 
-// template <typename T = float>
-inline std::chrono::duration<int64_t, std::nano> get_datetime_delta(std::string dt1, std::string dt2) {
-  std::tm            t{};
-  std::istringstream ss{dt1};
-  ss >> std::get_time(&t, "%Y-%m-%dT%H:%M:%S");
-
-  std::chrono::time_point tp_1 = std::chrono::system_clock::from_time_t(mktime(&t));
-
-  ss.clear();
-
-  ss.str(dt2);
-  ss >> std::get_time(&t, "%Y-%m-%dT%H:%M:%S");
-
-  std::chrono::time_point tp_2 = std::chrono::system_clock::from_time_t(mktime(&t));
-
-  std::chrono::duration<int64_t, std::nano> elapsed = tp_1 - tp_2;
-  return elapsed;
+/**
+ * get_datetime_delta
+ *
+ * Timestamps are looked up in a per-thread TimestampCache, as the same
+ * current time is compared against many previous dates.
+ *
+ * @param   [in]  {std::string_view} dt1 RFC 3339
+ * @param   [in]  {std::string_view} dt2 RFC 3339
+ * @returns [out] {std::chrono::nanoseconds} dt1 - dt2
+ */
+inline std::chrono::duration<int64_t, std::nano> get_datetime_delta(const std::string_view dt1, const std::string_view dt2) {
+  thread_local TimestampCache cache{};
+  return std::chrono::milliseconds{cache.get(dt1) - cache.get(dt2)};
 }
 
 // template <typename T = float>
-inline std::string datetime_delta_string(std::string dt1, std::string dt2) {
+inline std::string datetime_delta_string(const std::string_view dt1, const std::string_view dt2) {
   std::chrono::duration<int64_t, std::nano> datetime_delta = get_datetime_delta(dt1, dt2);
   return delta_to_string(datetime_delta);
 }
@@ -4,6 +4,9 @@
 #include <INIReader.h>
 #include <kjson.hpp>
 #include "types.hpp"
+#include "decoder.hpp"
+#include "pager.hpp"
+#include "chat_poller.hpp"
 
 namespace ktube {
 inline const std::string get_executable_cwd() {
@@ -20,26 +23,16 @@ inline INIReader GetConfigReader() {
   return INIReader{GetConfigPath()};
 }
 
-static std::vector<Comment> ParseComments(const nlohmann::json& data)
+/**
+ * youtube_id_to_url
+ *
+ * @param
+ * @returns
+ */
+inline std::string youtube_id_to_url(std::string id)
 {
-  std::vector<Comment> comments{};
-  if (!data.is_null() && data.is_object())
-  {
-    for (const auto& item : data["items"])
-      comments.emplace_back(
-        Comment{
-          .id       = kjson::GetJSONStringValue(     item, "id"),
-          .video_id = kjson::GetJSONStringValue(     item["snippet"], "videoId"),
-          .text     = kjson::GetJSONStringValue(     item["snippet"]["topLevelComment"]["snippet"],                    "textDisplay"),
-          .name     = kjson::GetJSONStringValue(     item["snippet"]["topLevelComment"]["snippet"],                    "authorDisplayName"),
-          .channel  = kjson::GetJSONStringValue(     item["snippet"]["topLevelComment"]["snippet"]["authorChannelId"], "value"),
-          .likes    = kjson::GetJSONValue<uint32_t>( item["snippet"]["topLevelComment"]["snippet"],                    "likeCount"),
-          .time     = kjson::GetJSONStringValue(     item["snippet"]["topLevelComment"]["snippet"],                    "publishedAt"),
-        }
-      );
-  }
-
-  return comments;
+  return std::string{
+      "https://youtube.com/watch?v=" + id};
 }
 
 } // namespace ktube
\ No newline at end of file
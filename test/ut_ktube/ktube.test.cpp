@@ -80,4 +80,919 @@ TEST(KTubeTest, FindAndCommentOnVideo)
 
   EXPECT_TRUE(result);
   EXPECT_TRUE(reply_result);
-}
\ No newline at end of file
+}
+
+TEST(KTubeTest, ChunkUniqueIDs)
+{
+  using namespace ktube;
+
+  IDList ids{};
+  for (int i = 0; i < 120; i++)
+    ids.emplace_back("id" + std::to_string(i % 101));
+
+  const IDList                   unique = UniqueIDs(SplitIDs("a,,b,a,c,"));
+  const std::vector<std::string> chunks = ChunkIDs(UniqueIDs(ids));
+
+  EXPECT_EQ(unique, (IDList{"a", "b", "c"}));
+  ASSERT_EQ(chunks.size(), 3);
+  EXPECT_EQ(SplitIDs(chunks.front()).size(), constants::youtube::MAX_IDS_PER_REQUEST);
+  EXPECT_EQ(SplitIDs(chunks.back()), (IDList{"id100"}));
+}
+
+TEST(KTubeTest, ResponseCacheKeysByNormalizedURL)
+{
+  using namespace ktube;
+
+  ResponseCache     cache{2};
+  const std::string key = ToURL("https://host/videos", QueryParams{{"part", "snippet"}, {"id", "a,b"}});
+
+  EXPECT_EQ(key, "https://host/videos?id=a%2Cb&part=snippet");
+
+  cache.put(key,     "etag_1", VideoStatsMap{{"a", VideoStats{.views = 1}}});
+  cache.put("other", "",       VideoStatsMap{});
+
+  ASSERT_TRUE(cache.get<VideoStatsMap>(key).has_value());
+  EXPECT_EQ(cache.get<VideoStatsMap>(key)->at("a").views, 1);
+  EXPECT_EQ(cache.etag(key), "etag_1");
+  EXPECT_EQ(cache.size(), 1);
+
+  cache.put("second", "etag_2", 2);
+  cache.put("third",  "etag_3", 3);
+
+  EXPECT_TRUE(cache.etag(key).empty());
+  EXPECT_FALSE(cache.get<VideoStatsMap>("second").has_value());
+  EXPECT_EQ(*cache.get<int>("third"), 3);
+}
+
+TEST(KTubeTest, PagerFetchesLazily)
+{
+  using namespace ktube;
+
+  const std::vector<Page<int>> pages{{{1, 2}, "b"}, {{}, "c"}, {{3}, "d"}, {{4, 5}, ""}};
+  std::atomic<int>             fetches{0};
+  Executor                     executor{2};
+
+  auto fetch = [&pages, &fetches](const std::string& token) {
+    fetches++;
+    return pages.at(token.empty() ? 0 : token.front() - 'a');
+  };
+
+  std::vector<int> all{};
+  for (const int value : Pager<int>{fetch, 0, &executor})
+    all.push_back(value);
+
+  EXPECT_EQ(all, (std::vector<int>{1, 2, 3, 4, 5}));
+  EXPECT_EQ(fetches, 4);
+
+  fetches = 0;
+  Pager<int> pager{fetch};
+  for (const int value : pager)
+    if (value == 2)
+      break;
+
+  EXPECT_EQ(fetches, 1);
+  EXPECT_EQ(pager.pages(), 1);
+
+  auto deferring = [&fetch, &executor](const std::string& token) { // quota queued on a worker
+    return (executor.in_worker()) ? Page<int>{{}, token} : fetch(token);
+  };
+
+  all.clear();
+  for (const int value : Pager<int>{deferring, 0, &executor})
+    all.push_back(value);
+
+  EXPECT_EQ(all, (std::vector<int>{1, 2, 3, 4, 5}));
+}
+
+TEST(KTubeTest, QuotaAdmitsByPriority)
+{
+  using namespace ktube;
+  using namespace ktube::constants;
+
+  const std::time_t NOON_PDT{1782932400}; // 2026-07-01 19:00 UTC
+  const std::time_t LATE_PDT{1782975540}; // 2026-07-01 23:59 PDT
+  const std::time_t DAWN_PDT{1782891000}; // 2026-07-01 00:30 PDT
+  const std::string path = testing::TempDir() + "ktube_quota.txt";
+  std::remove(path.c_str());
+
+  EXPECT_EQ(ToPacificDay(NOON_PDT).date,     "2026-07-01");
+  EXPECT_EQ(ToPacificDay(NOON_PDT).elapsed,  12 * 3600);
+  EXPECT_EQ(ToPacificDay(1768462200).date,   "2026-01-14"); // 2026-01-15 07:30 UTC
+
+  QuotaManager paced{path, 200};
+  EXPECT_EQ(paced.evaluate(youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore, NOON_PDT), Admission::queue);
+  EXPECT_EQ(paced.evaluate(youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore, LATE_PDT), Admission::admit);
+  EXPECT_EQ(paced.evaluate(youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::live,    NOON_PDT), Admission::admit);
+
+  QuotaManager daily{path, 10000};
+  EXPECT_EQ(daily.evaluate(youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore, DAWN_PDT), Admission::admit);
+
+  QuotaManager tight{path, 150};
+  EXPECT_EQ(tight.evaluate(youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::explore, LATE_PDT), Admission::reject);
+  EXPECT_EQ(tight.evaluate(youtube::SEARCH_LIST_QUOTA_INDEX, QuotaPriority::live,    LATE_PDT), Admission::admit);
+
+  std::remove(path.c_str());
+  {
+    QuotaManager ledger{path};
+    EXPECT_EQ(ledger.acquire(youtube::LIVE_CHAT_LIST_QUOTA_INDEX, QuotaPriority::live), Admission::admit);
+    EXPECT_EQ(ledger.acquire(youtube::VIDEO_LIST_QUOTA_INDEX,     QuotaPriority::live), Admission::admit);
+  }
+
+  QuotaManager restored{path};
+  EXPECT_EQ(restored.used(), 6);
+  EXPECT_EQ(restored.calls(youtube::LIVE_CHAT_LIST_QUOTA_INDEX), 1);
+  std::remove(path.c_str());
+}
+
+TEST(KTubeTest, RetrierBacksOffAndHedges)
+{
+  using namespace ktube;
+  using namespace std::chrono;
+
+  const RetryPolicy quick{3, milliseconds{1}, milliseconds{2}, milliseconds{0}};
+  std::atomic<int>  sends{0};
+  Retrier           retrier{true};
+
+  cpr::Response response = retrier.run(quick, [&sends] {
+    cpr::Response r{};
+    r.status_code = (++sends < 3) ? 503 : 200;
+    return r;
+  });
+
+  EXPECT_EQ(response.status_code, 200);
+  EXPECT_EQ(sends, 3);
+
+  sends = 0;
+  retrier.set_enabled(false);
+  EXPECT_EQ(retrier.run(quick, [&sends] { sends++; cpr::Response r{}; r.status_code = 503; return r; }).status_code, 503);
+  EXPECT_EQ(sends, 1);
+
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  retrier.set_enabled(true);
+  const auto start = steady_clock::now();
+
+  response = retrier.run(RetryPolicy::Hedged(milliseconds{20}), [calls] {
+    cpr::Response r{};
+    r.status_code = 200;
+    r.text        = (++*calls == 1) ? "stalled" : "hedge";
+    if (r.text == "stalled")
+      std::this_thread::sleep_for(milliseconds{500});
+    return r;
+  });
+
+  EXPECT_EQ(response.text, "hedge");
+  EXPECT_LT(duration_cast<milliseconds>(steady_clock::now() - start).count(), 400);
+
+  int admits{0};
+  sends = 0;
+  EXPECT_EQ(retrier.run(quick, [&sends] { sends++; cpr::Response r{}; r.status_code = 503; return r; },
+                               [&admits] { return ++admits < 2; }).status_code, 503);
+  EXPECT_EQ(sends,  2);
+  EXPECT_EQ(admits, 2);
+
+  *calls = 0;
+  response = retrier.run(RetryPolicy::Hedged(milliseconds{20}), [calls] {
+    cpr::Response r{};
+    r.status_code = 200;
+    r.text        = std::to_string(++*calls);
+    std::this_thread::sleep_for(milliseconds{50});
+    return r;
+  }, [] { return false; });
+
+  EXPECT_EQ(response.text, "1");
+  EXPECT_EQ(*calls, 1);
+
+  Retrier refused{true};
+  for (int i = 0; i < 20; i++) // refused retries must not spend the budget
+    refused.run(quick, [] { cpr::Response r{}; r.status_code = 503; return r; }, [] { return false; });
+
+  sends = 0;
+  EXPECT_EQ(refused.run(quick, [&sends] { cpr::Response r{}; r.status_code = (++sends < 2) ? 503 : 200; return r; }).status_code, 200);
+  EXPECT_EQ(sends, 2);
+}
+
+TEST(KTubeTest, ChatPollerFollowsPageTokens)
+{
+  using namespace ktube;
+  using namespace std::chrono;
+
+  std::vector<std::string> tokens{};
+  LiveMessages             delivered{};
+
+  ChatPoller poller{[&tokens](const std::string& page_token) {
+    tokens.push_back(page_token);
+    if (page_token == "b") // failed poll
+      return ChatPoll{Page<LiveMessage>{}, milliseconds{0}};
+    return ChatPoll{Page<LiveMessage>{{LiveMessage{.text = "message " + page_token}}, page_token + "b"}, milliseconds{60000}};
+  }};
+
+  poller.subscribe([&delivered](const LiveMessages& messages) {
+    delivered.insert(delivered.end(), messages.begin(), messages.end());
+  });
+
+  EXPECT_TRUE(poller.due());
+  EXPECT_EQ(poller.poll(), 1);
+  EXPECT_FALSE(poller.due());
+  EXPECT_EQ(poller.interval(), milliseconds{60000});
+  EXPECT_EQ(poller.page_token(), "b");
+
+  EXPECT_EQ(poller.poll(), 0);
+  EXPECT_EQ(poller.page_token(), "b");
+
+  EXPECT_EQ(tokens, (std::vector<std::string>{"", "b"}));
+  ASSERT_EQ(delivered.size(), 1);
+  EXPECT_EQ(delivered.front().text, "message ");
+
+  std::promise<void> stopped{};
+  {
+    auto looping = std::make_unique<ChatPoller>([](const std::string& page_token) {
+      return ChatPoll{Page<LiveMessage>{{LiveMessage{.id = page_token + "x"}}, page_token + "x"}, milliseconds{1}};
+    });
+
+    looping->subscribe([&looping, &stopped](const LiveMessages&) {
+      looping->stop();
+      stopped.set_value();
+    });
+
+    looping->start();
+    stopped.get_future().wait();
+    EXPECT_FALSE(looping->running());
+  } // joined by the owner, not detached
+
+  const auto endless = [](const std::string& page_token) {
+    return ChatPoll{Page<LiveMessage>{{LiveMessage{.id = page_token + "x"}}, page_token + "x"}, milliseconds{1}};
+  };
+
+  std::promise<void>          destroyed{};
+  std::shared_ptr<ChatPoller> owned = std::make_shared<ChatPoller>(endless);
+  owned->subscribe([&owned, &destroyed](const LiveMessages&) {
+    if (owned)
+    {
+      owned.reset(); // the last reference goes on the polling thread
+      destroyed.set_value();
+    }
+  });
+  owned->start();
+  destroyed.get_future().wait();
+  EXPECT_FALSE(owned);
+
+  ChatPoller shared{endless};
+  shared.start();
+  std::thread other{[&shared] { shared.stop(); }};
+  shared.stop(); // only one of the two joins the loop
+  other.join();
+  EXPECT_FALSE(shared.running());
+  shared.start();
+  EXPECT_TRUE(shared.running());
+}
+
+TEST(KTubeTest, MessageIndexDropsSeenMessages)
+{
+  using namespace ktube;
+
+  EXPECT_EQ(to_epoch_ms("1970-01-01T00:00:01.5Z"),            1500);
+  EXPECT_EQ(to_epoch_ms("2021-02-05T19:06:47.258000Z"),       1612552007258);
+  EXPECT_EQ(to_epoch_ms("2021-02-05T11:06:47.258-08:00"),     1612552007258);
+  EXPECT_EQ(to_epoch_ms("not a timestamp"),                   0);
+
+  const int64_t now = to_epoch_ms("2021-02-05T19:06:47Z");
+  MessageIndex  index{2, 60000};
+
+  EXPECT_TRUE (index.insert(LiveMessage{.id = "a", .published = now}));
+  EXPECT_FALSE(index.insert(LiveMessage{.id = "a", .published = now}));
+  EXPECT_TRUE (index.insert(LiveMessage{.id = "b", .published = now + 1000}));
+  EXPECT_TRUE (index.insert(LiveMessage{.id = "c", .published = now + 2000}));
+  EXPECT_EQ   (index.size(), 2);
+  EXPECT_EQ   (index.watermark(), now + 2000);
+  EXPECT_FALSE(index.insert(LiveMessage{.id = "d", .published = now - 120000}));
+  EXPECT_FALSE(index.insert(LiveMessage{.id = "c", .published = now + 2000}));
+}
+
+TEST(KTubeTest, TimestampsParseAndFormatInUTC)
+{
+  using namespace ktube;
+
+  const int64_t ms = to_epoch_ms("2021-02-05T19:06:47.258Z");
+  char          buffer[constants::DATETIME_BUFFER_SIZE];
+
+  EXPECT_EQ(std::string(buffer, format_datetime(ms, buffer)),      "2021-02-05T19:06:47");
+  EXPECT_EQ(std::string(buffer, format_readable_time(ms, buffer)), "February 05 19:06:47");
+  EXPECT_EQ(to_readable_time("2020-09-30T16:59:59-07:00"),         "September 30 23:59:59");
+  EXPECT_EQ(to_readable_time("2020-13-30T16:59:59Z"),              "");
+  EXPECT_EQ(to_unixtime("2021-02-05T19:06:47Z"),                   1612552007);
+  EXPECT_EQ(to_epoch_ms("1969-12-31T23:59:59.5Z"),                 -500);
+  EXPECT_EQ(std::string(buffer, format_datetime(-500, buffer)),    "1969-12-31T23:59:59");
+  EXPECT_EQ(to_epoch_ms(get_simple_datetime()) / 86400000,
+            std::chrono::duration_cast<std::chrono::hours>(
+              std::chrono::system_clock::now().time_since_epoch()).count() / 24);
+
+  TimestampCache cache{};
+  EXPECT_EQ(cache.get("2021-02-05T19:06:47.258Z"), ms);
+  EXPECT_EQ(cache.get("2021-02-05T19:06:47.258Z"), ms);
+  EXPECT_EQ(cache.get("garbage"),                  0);
+
+  EXPECT_EQ(datetime_delta_string("2021-02-06T20:07:48", "2021-02-05T19:06:47"), "01d:01h:01m:01s");
+}
+
+TEST(KTubeTest, ChatBufferKeepsNewestMessages)
+{
+  using namespace ktube;
+
+  ChatBuffer buffer{3};
+  for (int i = 0; i < 5; i++)
+    buffer.push(LiveMessage{.id = std::to_string(i), .published = 1000 * i});
+
+  std::vector<std::string> ids{};
+  ChatBuffer::Cursor       cursor = buffer.read(0, [&ids](const LiveMessage& message) { ids.push_back(message.id); });
+
+  EXPECT_EQ(ids, (std::vector<std::string>{"2", "3", "4"}));
+  EXPECT_EQ(cursor, 5);
+
+  buffer.push(LiveMessage{.id = "5", .published = 5000});
+  ids.clear();
+  cursor = buffer.read(cursor, [&ids](const LiveMessage& message) { ids.push_back(message.id); });
+
+  EXPECT_EQ(ids, (std::vector<std::string>{"5"}));
+
+  buffer.set_retention(8, 1500);
+  EXPECT_EQ(buffer.size(), 2);
+  EXPECT_EQ(buffer.messages().front().id, "4");
+
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.end(), cursor);
+}
+
+TEST(KTubeTest, TakeVariantsMoveResultsOut)
+{
+  using namespace ktube;
+
+  ChatBuffer buffer{4};
+  for (int i = 0; i < 3; i++)
+    buffer.push(LiveMessage{.id = std::to_string(i), .text = std::string(64, 'x')});
+
+  const LiveMessages messages = buffer.take();
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_EQ(messages.back().id, "2");
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.end(), 3);
+
+  ContentComparator comparator{};
+  EXPECT_TRUE (comparator.add_content("channel", {}));
+  EXPECT_FALSE(comparator.add_content("channel", {}));
+
+  VideoCreatorComparison comparison = comparator.take_analysis();
+  EXPECT_EQ(comparison.get_result().get_result_map().size(), 1);
+  comparison.analyze(); // the studies were moved into the analyst; a second call keeps the result
+  EXPECT_EQ(comparison.get_result().get_result_map().size(), 1);
+  EXPECT_TRUE(comparator.add_content("channel", {}));
+}
+
+TEST(KTubeTest, MentionMatcherFindsAllPatternsInOnePass)
+{
+  using namespace ktube;
+
+  MentionMatcher matcher{};
+  matcher.add("KBot",   MentionType::name);
+  matcher.add("bot",    MentionType::alias);
+  matcher.add("!q",     MentionType::command);
+  matcher.add("seoul",  MentionType::keyword);
+  matcher.build();
+
+  std::vector<std::pair<std::string, std::size_t>> found{};
+  matcher.scan("hey kbot, !q is Seoul nice? abc!q", [&matcher, &found](const MentionMatch& match) {
+    found.emplace_back(matcher.pattern(match.pattern), match.offset);
+  });
+
+  EXPECT_EQ(found, (std::vector<std::pair<std::string, std::size_t>>{
+    {"KBot", 4}, {"!q", 10}, {"seoul", 16}}));
+
+  EXPECT_TRUE (matcher.contains("KBOT"));
+  EXPECT_TRUE (matcher.contains("hi @bot!"));
+  EXPECT_FALSE(matcher.contains("a robot studies botany"));
+  EXPECT_FALSE(matcher.contains("nothing to see"));
+}
+
+TEST(KTubeTest, TokenizeMessagesOnlyOnce)
+{
+  using namespace ktube;
+
+  Executor         executor{4};
+  ChatBuffer       chat{};
+  std::atomic<int> calls{0};
+  auto             tokenize = [&calls](const std::string& text) {
+    calls++;
+    return std::vector<Token>(text.size());
+  };
+
+  for (const auto& text : {"a", "bb", "ccc"})
+    chat.push(LiveMessage{.text = text});
+
+  ChatBuffer::Cursor cursor = TokenizeMessages(chat, 0, executor, tokenize);
+  EXPECT_EQ(calls, 3);
+
+  chat.push(LiveMessage{.text = "dddd"});
+  cursor = TokenizeMessages(chat, cursor, executor, tokenize);
+  EXPECT_EQ(calls, 4);
+
+  TokenizeMessages(chat, 0, executor, tokenize);
+  EXPECT_EQ(calls, 4);
+  EXPECT_EQ(cursor, 4);
+
+  std::vector<std::size_t> sizes{};
+  chat.read(0, [&sizes](const LiveMessage& message) {
+    EXPECT_TRUE(message.tokenized);
+    sizes.push_back(message.tokens.size());
+  });
+  EXPECT_EQ(sizes, (std::vector<std::size_t>{1, 2, 3, 4}));
+}
+
+TEST(KTubeTest, ChatHubPollsEverySessionThatIsDue)
+{
+  using namespace ktube;
+  using namespace std::chrono;
+
+  Executor         executor{4};
+  std::atomic<int> fetches{0};
+  ChatHub          hub{[&fetches](const std::string& chat_id) {
+    return std::make_unique<ChatPoller>([&fetches, chat_id](const std::string& page_token) {
+      fetches++;
+      return ChatPoll{Page<LiveMessage>{{LiveMessage{.id = chat_id + page_token}}, page_token + "n"},
+                      milliseconds{(chat_id == "fast") ? 1 : 60000}};
+    });
+  }, executor};
+
+  std::map<std::string, std::size_t> received{};
+  std::mutex                         mutex{};
+  for (const std::string chat_id : {"fast", "slow"})
+    hub.add(chat_id, [&received, &mutex, chat_id](const LiveMessages& messages) {
+      std::lock_guard<std::mutex> lock{mutex};
+      received[chat_id] += messages.size();
+    });
+
+  EXPECT_FALSE(hub.add("fast", nullptr));
+  EXPECT_EQ   (hub.poll(), 2);
+  EXPECT_EQ   (hub.session("fast")->page_token(), "n");
+
+  std::this_thread::sleep_for(milliseconds{5});
+  EXPECT_EQ(hub.poll(), 1);
+  EXPECT_EQ(fetches, 3);
+  EXPECT_EQ(received["fast"], 2);
+  EXPECT_EQ(received["slow"], 1);
+
+  EXPECT_TRUE(hub.remove("slow"));
+  EXPECT_EQ  (hub.chats(), (std::vector<std::string>{"fast"}));
+}
+
+TEST(KTubeTest, ChatHubSchedulesSessionsIndependently)
+{
+  using namespace ktube;
+  using namespace std::chrono;
+
+  Executor           executor{2};
+  std::atomic<int>   fetches{0};
+  std::atomic<int>   fast{0};
+  std::promise<void> entered{};
+  std::promise<void> release{};
+  std::shared_future<void> released = release.get_future().share();
+
+  ChatHub hub{[&fetches](const std::string& chat_id) {
+    return std::make_unique<ChatPoller>([&fetches, chat_id](const std::string& page_token) {
+      fetches++;
+      return ChatPoll{Page<LiveMessage>{{LiveMessage{.id = chat_id + page_token}}, page_token + "n"}, milliseconds{1}};
+    });
+  }, executor};
+
+  hub.add("held", [&hub, &entered, released](const LiveMessages&) {
+    EXPECT_TRUE(hub.remove("held")); // no hub-wide lock is held during a poll
+    entered.set_value();
+    released.wait();
+  });
+  hub.add("fast", [&fast](const LiveMessages&) { fast++; });
+
+  hub.start();
+  entered.get_future().wait();
+
+  EXPECT_EQ(hub.chats(), (std::vector<std::string>{"fast"}));
+  while (fast < 5) // polled again and again while "held" is stuck
+    std::this_thread::yield();
+
+  release.set_value();
+  hub.stop();
+  EXPECT_GE(fetches, 6);
+  EXPECT_EQ(hub.size(), 1);
+}
+
+TEST(KTubeTest, BoundedQueueCarriesEveryItemFromManyProducers)
+{
+  using namespace ktube;
+
+  BoundedQueue<int> queue{1000};
+  EXPECT_EQ(queue.capacity(), 1024);
+
+  std::vector<std::thread> producers{};
+  for (int p = 0; p < 4; p++)
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < 10000; i++)
+        while (!queue.try_push(p * 10000 + i))
+          std::this_thread::yield();
+    });
+
+  std::vector<int> last(4, -1);
+  int              value{}, count{0};
+  while (count < 40000)
+    if (queue.try_pop(value))
+    {
+      EXPECT_GT(value % 10000, last[value / 10000]);
+      last[value / 10000] = value % 10000;
+      count++;
+    }
+
+  for (auto& producer : producers)
+    producer.join();
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(KTubeTest, ChatPipelineIngestsWhileSenderIsSlow)
+{
+  using namespace ktube;
+  using namespace std::chrono;
+
+  std::promise<void>       entered{};
+  std::promise<void>       release{};
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<bool>        blocked{false};
+
+  ChatPipeline pipeline{
+    [](const ChatBatch& batch, std::vector<ChatReply>& replies) {
+      replies.push_back(ChatReply{batch.chat_id, "reply"});
+    },
+    [&entered, &blocked, released](const ChatReply&, ChatPipeline::Done done) {
+      if (!blocked.exchange(true))
+      {
+        entered.set_value();
+        released.wait(); // the sender is stuck until released
+      }
+      done(true);
+    },
+    4, 2};
+
+  pipeline.start();
+  pipeline.ingest(ChatBatch{"chat", 0, {LiveMessage{.id = "a"}}});
+  entered.get_future().wait();
+
+  // every ingest returns while the sender is blocked, so polling is never held up
+  std::size_t accepted{1};
+  for (int i = 0; i < 50; i++)
+    accepted += pipeline.ingest(ChatBatch{"chat", 0, {}});
+
+  while (pipeline.stats().reply_stalls == 0)
+    std::this_thread::yield();
+
+  release.set_value();
+  pipeline.stop();
+
+  const PipelineStats stats = pipeline.stats();
+  EXPECT_GT(stats.ingest_stalls, 0);
+  EXPECT_GT(stats.reply_stalls,  0);
+  EXPECT_GE(stats.replies,       1);
+  EXPECT_LE(stats.replies + stats.failures, accepted);
+  EXPECT_EQ(stats.ingest_depth,  0); // stop() leaves nothing queued
+  EXPECT_EQ(stats.reply_depth,   0);
+
+  std::promise<void> posted{};
+  ChatOutbox outbox{[&posted](const std::string& chat_id, const std::string&) {
+    posted.set_value();
+    return chat_id != "closed";
+  }, OutboxPolicy{milliseconds{0}, 200, false}};
+
+  ChatPipeline reporting{
+    [](const ChatBatch& batch, std::vector<ChatReply>& replies) { replies.push_back(ChatReply{batch.chat_id, "reply"}); },
+    [&outbox](const ChatReply& reply, ChatPipeline::Done done) { outbox.post(reply.chat_id, reply.text, std::move(done)); }};
+
+  reporting.start();
+  reporting.ingest(ChatBatch{"closed", 0, {}});
+  posted.get_future().wait();
+  reporting.stop();
+  outbox.stop();
+
+  EXPECT_EQ(reporting.stats().replies,  0); // the outbox's result, not an assumed success
+  EXPECT_EQ(reporting.stats().failures, 1);
+
+  std::promise<void> sent{};
+  ChatPipeline idle{
+    [](const ChatBatch& batch, std::vector<ChatReply>& replies) { replies.push_back(ChatReply{batch.chat_id, "reply"}); },
+    [&sent](const ChatReply&, ChatPipeline::Done done) { sent.set_value(); done(true); }};
+
+  idle.start();
+  std::this_thread::sleep_for(milliseconds{50}); // both stages are blocked by now
+  idle.ingest(ChatBatch{"chat", 0, {}});
+  EXPECT_EQ(sent.get_future().wait_for(seconds{5}), std::future_status::ready);
+  idle.stop(); // wakes the blocked stages instead of hanging
+  EXPECT_EQ(idle.stats().replies, 1);
+}
+
+TEST(KTubeTest, ChatOutboxRateLimitsAndCoalescesPerChat)
+{
+  using namespace ktube;
+  using namespace std::chrono;
+
+  std::mutex                                       mutex{};
+  std::vector<std::pair<std::string, std::string>> posts{};
+  ChatOutbox outbox{[&mutex, &posts](const std::string& chat_id, const std::string& text) {
+    std::lock_guard<std::mutex> lock{mutex};
+    posts.emplace_back(chat_id, text);
+    return chat_id != "closed";
+  }, OutboxPolicy{milliseconds{50}, 12, true}};
+
+  std::vector<std::future<bool>> results{};
+  for (const auto& text : {"a", "b", "c", "dddddddddd"})
+    results.push_back(outbox.post("busy", text, true));
+  results.push_back(outbox.post("other",  "x"));
+  results.push_back(outbox.post("closed", "y"));
+
+  for (std::size_t i = 0; i < results.size() - 1; i++)
+    EXPECT_TRUE(results[i].get());
+  EXPECT_FALSE(results.back().get());
+
+  std::map<std::string, std::vector<std::string>> sent{};
+  for (const auto& [chat_id, text] : posts)
+    sent[chat_id].push_back(text);
+
+  std::string joined{};
+  for (const auto& text : sent["busy"])
+  {
+    EXPECT_LE(text.size(), 12);
+    joined += (joined.empty() ? "" : ChatOutbox::SEPARATOR) + text;
+  }
+  EXPECT_EQ(joined, "a | b | c | dddddddddd");
+  EXPECT_LT(sent["busy"].size(), 4);
+  EXPECT_EQ(outbox.stats().messages, 5);
+  EXPECT_EQ(outbox.stats().failures, 1);
+  EXPECT_GT(outbox.stats().coalesced, 0);
+
+  std::promise<void>       release{};
+  std::shared_future<void> released = release.get_future().share();
+  ChatOutbox separate{[released](const std::string& chat_id, const std::string&) {
+    if (chat_id == "slow")
+      released.wait();
+    return true;
+  }, OutboxPolicy{milliseconds{0}, 200, true}};
+
+  std::future<bool> slow  = separate.post("slow", "a");
+  std::future<bool> fast  = separate.post("fast", "b");
+  std::future<bool> again = separate.post("fast", "c");
+  EXPECT_TRUE(fast.get()); // not held up behind the slow chat's post
+  EXPECT_TRUE(again.get());
+  EXPECT_EQ(separate.stats().coalesced, 0); // coalescing is opt-in per message
+  EXPECT_EQ(slow.wait_for(milliseconds{0}), std::future_status::timeout);
+
+  release.set_value();
+  EXPECT_TRUE(slow.get());
+}
+
+TEST(KTubeTest, InteractionStoreInternsAndSnapshots)
+{
+  using namespace ktube;
+
+  InternTable table{};
+  for (int i = 0; i < 1000; i++)
+    EXPECT_EQ(table.intern("user" + std::to_string(i)), i);
+  EXPECT_EQ(table.intern("user500"), 500);
+  EXPECT_EQ(table.find("user999"), 999);
+  EXPECT_EQ(table.find("nobody"),  InternTable::npos);
+  EXPECT_EQ(table.at(42),          "user42");
+
+  const std::string path = testing::TempDir() + "ktube_interactions_test.txt";
+  std::remove(path.c_str());
+  {
+    InteractionStore store{};
+    EXPECT_TRUE(store.open(path));
+    store.record("UC1", Interaction::greeting, "Alice");
+    store.record("UC1", Interaction::location_ask, "Seoul");
+    store.record("UC2", Interaction::promotion);
+    store.record("UC2", Interaction::location_ask, "New\nYork City");
+  }
+
+  InteractionStore store{};
+  store.open(path);
+  EXPECT_TRUE (store.has_interacted("UC1", Interaction::greeting));
+  EXPECT_TRUE (store.has_interacted("UC1", Interaction::location_ask));
+  EXPECT_FALSE(store.has_interacted("UC1", Interaction::promotion));
+  EXPECT_TRUE (store.has_interacted("UC2", Interaction::promotion));
+  EXPECT_FALSE(store.has_interacted("UC3", Interaction::greeting));
+  EXPECT_TRUE (store.has_discussed("Seoul", Interaction::location_ask));
+  EXPECT_FALSE(store.has_discussed("Seoul", Interaction::greeting));
+  EXPECT_FALSE(store.has_discussed("Busan", Interaction::location_ask));
+  EXPECT_TRUE (store.has_discussed("New\nYork City", Interaction::location_ask));
+  EXPECT_EQ   (store.users(),  2);
+  EXPECT_EQ   (store.values(), 3);
+  std::remove(path.c_str());
+}
+
+TEST(KTubeTest, ChatRecorderReplaysAtSpeed)
+{
+  using namespace ktube;
+  using namespace std::chrono;
+
+  const std::string path = testing::TempDir() + "ktube_chat_record_test.bin";
+  std::remove(path.c_str());
+  {
+    ChatRecorder recorder{};
+    EXPECT_FALSE(recorder.append("chat", 0, "dropped"));
+    EXPECT_TRUE (recorder.open(path));
+    EXPECT_TRUE (recorder.append("chat", 1000, R"({"items":[]})"));
+    EXPECT_TRUE (recorder.append("chat", 1100, std::string("bin\0ary", 7)));
+    EXPECT_TRUE (recorder.append("other", 1200, ""));
+  }
+
+  std::vector<ChatRecord> records{};
+  const auto              start    = steady_clock::now();
+  const std::size_t       replayed = ChatReplay{path, 10}.run([&records](const ChatRecord& record) {
+    records.push_back(record);
+  });
+
+  EXPECT_EQ(replayed, 3);
+  EXPECT_GE(steady_clock::now() - start, milliseconds{20});
+  EXPECT_EQ(records[0].body,     R"({"items":[]})");
+  EXPECT_EQ(records[1].body,     std::string("bin\0ary", 7));
+  EXPECT_EQ(records[1].received, 1100);
+  EXPECT_EQ(records[2].chat_id,  "other");
+  EXPECT_TRUE(records[2].body.empty());
+
+  StageLatency latency{};
+  latency.add(microseconds{10});
+  latency.add(microseconds{30});
+  EXPECT_EQ(latency.mean(), microseconds{20});
+  EXPECT_EQ(latency.max,    microseconds{30});
+  std::remove(path.c_str());
+}
+
+TEST(KTubeTest, ReplayChatDropsRepeatedMessages)
+{
+  using namespace ktube;
+
+  const std::string path = testing::TempDir() + "ktube_chat_replay_test.bin";
+  const std::string page = R"({"items": [
+    {"id": "m1", "snippet": {"textMessageDetails": {"messageText": "hello"}}},
+    {"id": "m2", "snippet": {"textMessageDetails": {"messageText": "there"}}}]})";
+  std::remove(path.c_str());
+  {
+    ChatRecorder recorder{};
+    EXPECT_TRUE(recorder.open(path));
+    EXPECT_TRUE(recorder.append("replay", 1000, page));
+    EXPECT_TRUE(recorder.append("replay", 1100, page)); // the same page polled twice
+  }
+
+  YouTubeDataAPI    api{};
+  const ReplayStats stats = api.ReplayChat(path, 0);
+
+  EXPECT_EQ(stats.records,  2);
+  EXPECT_EQ(stats.messages, 2);
+  EXPECT_EQ(api.GetChat("replay").size(), 2);
+  EXPECT_TRUE(api.GetLiveDetails().chat_id.empty()); // the current chat is untouched
+  std::remove(path.c_str());
+}
+
+TEST(KTubeTest, DecodeVideoStatsDecodesCountsOnce)
+{
+  using namespace ktube;
+
+  const VideoStatsMap stats = DecodeVideoStats(R"({"items": [
+    {"id": "a", "snippet": {}, "statistics": {"viewCount": "9876543210", "likeCount": "12", "commentCount": "x"}}
+  ]})");
+
+  const VideoStats& video = stats.at("a");
+  EXPECT_EQ(video.views,    9876543210ULL);
+  EXPECT_EQ(video.likes,    12);
+  EXPECT_EQ(video.dislikes, 0);
+  EXPECT_EQ(video.comments, 0);
+}
+
+TEST(KTubeTest, SaxDecodersSkipUnreadFields)
+{
+  using namespace ktube;
+
+  const Page<Video> videos = DecodeVideoPage(R"({"kind": "youtube#searchListResponse", "nextPageToken": "CAUQAA",
+    "items": [
+      {"id": {"kind": "youtube#video", "videoId": "v1"},
+       "snippet": {"channelId": "c1", "title": "First", "description": "d", "publishedAt": "2021-03-04T05:06:07Z",
+                   "thumbnails": {"default": {"url": "ignored", "title": "ignored"}}, "tags": [{"title": "ignored"}]}},
+      {"id": {"kind": "youtube#channel"}, "snippet": {"title": "No video id"}},
+      {"id": {"videoId": "v2"}, "snippet": {"title": "Second"}}
+    ]})");
+
+  ASSERT_EQ(videos.items.size(), 2);
+  EXPECT_EQ(videos.next_page_token,       "CAUQAA");
+  EXPECT_EQ(videos.items[0].id,           "v1");
+  EXPECT_EQ(videos.items[0].channel_id,   "c1");
+  EXPECT_EQ(videos.items[0].title,        "First");
+  EXPECT_EQ(videos.items[0].datetime,     "2021-03-04T05:06:07Z");
+  EXPECT_EQ(videos.items[0].url,          youtube_id_to_url("v1"));
+  EXPECT_EQ(videos.items[1].title,        "Second");
+
+  const ChannelInfoMap channels = DecodeChannelInfo(R"({"items": [{"id": "c1",
+    "snippet":    {"title": "Chan", "thumbnails": {"default": {"url": "thumb"}, "high": {"url": "big"}}},
+    "statistics": {"viewCount": "100", "subscriberCount": "7", "hiddenSubscriberCount": false, "videoCount": 3}}]})");
+
+  const ChannelInfo& channel = channels.at("c1");
+  EXPECT_EQ(channel.name,              "Chan");
+  EXPECT_EQ(channel.thumb_url,         "thumb");
+  EXPECT_EQ(channel.stats.views,       100);
+  EXPECT_EQ(channel.stats.subscribers, 7);
+  EXPECT_EQ(channel.stats.videos,      3);
+
+  const Page<Comment> comments = DecodeCommentPage(R"({"items": [{"id": "t1", "snippet": {"videoId": "v1",
+    "topLevelComment": {"id": "t1", "snippet": {"textDisplay": "Nice", "authorDisplayName": "Ann",
+      "authorChannelId": {"value": "u1"}, "likeCount": 4, "publishedAt": "2021-03-04T05:06:07Z"}}}}]})");
+
+  ASSERT_EQ(comments.items.size(), 1);
+  EXPECT_EQ(comments.items[0].video_id, "v1");
+  EXPECT_EQ(comments.items[0].text,     "Nice");
+  EXPECT_EQ(comments.items[0].channel,  "u1");
+  EXPECT_EQ(comments.items[0].likes,    4);
+
+  EXPECT_TRUE(DecodeVideoPage(R"({"items": [{"id": {"videoId": "v1"})").items.empty());
+}
+
+TEST(KTubeTest, SchemaDecodersDefaultMissingAndMistypedFields)
+{
+  using namespace ktube;
+
+  const ChatPoll poll = DecodeChatPoll(R"({"nextPageToken": "next", "pollingIntervalMillis": 2500, "items": [
+    {"id": "m1", "snippet": {"publishedAt": "2021-03-04T05:06:07Z", "authorChannelId": "u1",
+                             "textMessageDetails": {"messageText": "hello"}}},
+    {"id": "m2", "snippet": {"authorChannelId": {"value": "not a string"}, "textMessageDetails": null}},
+    {"snippet": {"textMessageDetails": {"messageText": "no id"}}}
+  ]})");
+
+  ASSERT_EQ(poll.page.items.size(), 2);
+  EXPECT_EQ(poll.page.next_page_token,    "next");
+  EXPECT_EQ(poll.interval,                std::chrono::milliseconds{2500});
+  EXPECT_EQ(poll.page.items[0].author,    "u1");
+  EXPECT_EQ(poll.page.items[0].text,      "hello");
+  EXPECT_EQ(poll.page.items[0].published, to_epoch_ms("2021-03-04T05:06:07Z"));
+  EXPECT_TRUE(poll.page.items[1].author.empty());
+  EXPECT_TRUE(poll.page.items[1].text.empty());
+
+  EXPECT_EQ(DecodeChatPoll("not json").interval,
+            std::chrono::milliseconds{constants::youtube::DEFAULT_CHAT_POLL_INTERVAL_MS});
+
+  const std::vector<VideoDetails> search = DecodeVideoDetails(R"({"items": [{"id": {"videoId": "v1"},
+    "snippet": {"title": "Live", "channelTitle": "Chan", "thumbnails": {"high": {"url": "thumb"}}}}]})").items;
+  const std::vector<VideoDetails> videos = DecodeVideoDetails(R"({"items": [{"id": "v1",
+    "liveStreamingDetails": {"activeLiveChatId": "chat"}}]})").items;
+
+  ASSERT_EQ(search.size(), 1);
+  ASSERT_EQ(videos.size(), 1);
+  EXPECT_EQ(search[0].id,            "v1");
+  EXPECT_EQ(search[0].channel_title, "Chan");
+  EXPECT_EQ(search[0].thumbnail,     "thumb");
+  EXPECT_EQ(videos[0].id,            "v1");
+  EXPECT_EQ(videos[0].chat_id,       "chat");
+}
+
+TEST(KTubeTest, VideoTableRoundTripsAndScansColumns)
+{
+  using namespace ktube;
+
+  std::vector<Video> videos{};
+  for (uint64_t i = 0; i < 5; i++)
+  {
+    Video video{};
+    video.channel_id     = (i % 2) ? "odd" : "even";
+    video.id             = "v" + std::to_string(i);
+    video.datetime       = "2021-03-04T05:06:07Z";
+    video.stats.views    = 100 * (i + 1);
+    video.stats.likes    = (i == 3) ? 90 : i;
+    video.stats.comments = 5 - i;
+    video.stats.keywords = {"k" + std::to_string(i)};
+    videos.emplace_back(std::move(video));
+  }
+
+  VideoTable table{videos};
+
+  ASSERT_EQ(table.size(), 5);
+  EXPECT_EQ(table.channels()[0], table.channels()[2]);
+  EXPECT_NE(table.channels()[0], table.channels()[1]);
+  EXPECT_EQ(table.channel(3),    "odd");
+  EXPECT_EQ(table.published()[0], to_epoch_ms("2021-03-04T05:06:07Z"));
+
+  EXPECT_EQ(VideoTable::ArgMax(table.likes()),    3);
+  EXPECT_EQ(VideoTable::ArgMax(table.comments()), 0);
+  EXPECT_EQ(VideoTable::ArgMax(std::vector<uint64_t>{}), VideoTable::npos);
+
+  table.score(table.published()[0] + 100 * 60000);
+  EXPECT_DOUBLE_EQ(table.view_scores()[1], 2000.0);
+  EXPECT_DOUBLE_EQ(table.like_scores()[3], 90.0 / 400);
+  EXPECT_EQ(VideoTable::ArgMax(table.like_scores()), 3);
+
+  const Video video = table.video(4);
+  EXPECT_EQ(video.channel_id,     "even");
+  EXPECT_EQ(video.id,             "v4");
+  EXPECT_EQ(video.stats.views,    500);
+  EXPECT_EQ(video.stats.keywords, std::vector<std::string>{"k4"});
+  EXPECT_EQ(table.videos().size(), 5);
+}